@@ -3,7 +3,9 @@
  * @copyright defined in gxc/LICENSE
  */
 #include <gxc.game/gxc.game.hpp>
+#include <gxclib/dispatcher.hpp>
 #include <gxclib/game.hpp>
+#include <gxclib/token.hpp>
 
 namespace gxc {
 
@@ -22,6 +24,9 @@ void game_contract::setgame(name name, bool activated) {
       check(it != gms.end(), "not registered game");
       gms.erase(it);
    }
+
+   // update cached registration of tokens issued by the game, sent without authority as it is permissionless
+   token_contract_mock().syncgame(name);
 }
 
 void game_contract::seturi(name name, std::string uri) {
@@ -37,3 +42,5 @@ void game_contract::seturi(name name, std::string uri) {
 }
 
 }
+
+GXC_DISPATCH_SAFE(gxc::game_contract, (setgame)(seturi))
@@ -10,6 +10,7 @@
 #include <gxclib/system.hpp>
 #include <gxclib/game.hpp>
 #include <gxclib/action.hpp>
+#include <gxclib/check.hpp>
 
 using namespace eosio;
 
@@ -20,17 +21,45 @@ public:
    using contract::contract;
    using key_value = std::pair<std::string, std::vector<int8_t>>;
 
+   struct claim_param {
+      name           owner;
+      extended_asset value;
+
+      EOSLIB_SERIALIZE(claim_param, (owner)(value))
+   };
+
    [[eosio::action]]
    void mint(extended_asset derivative, extended_asset underlying, std::vector<key_value> opts);
 
    [[eosio::action]]
    void claim(name owner, extended_asset value);
 
+   [[eosio::action]]
+   void claimmany(std::vector<claim_param> claims);
+
    struct [[eosio::table("reserve"), eosio::contract("gxc.reserve")]] currency_reserves {
       asset derivative;
       name  issuer;
       asset underlying;
 
+      // Claim ratio is the fraction underlying.amount / derivative.amount of integer amounts,
+      // and precisions of both assets are cancelled out.
+
+      // underlying amount exchanged for given derivative amount, rounded down
+      int64_t to_underlying(int64_t amount)const {
+         auto result = static_cast<uint128_t>(amount) * underlying.amount / derivative.amount;
+         check(result <= asset::max_amount, "underlying amount overflow");
+         return static_cast<int64_t>(result);
+      }
+
+      // minimum derivative amount required for given underlying amount, rounded up
+      int64_t to_derivative(int64_t amount)const {
+         auto num = static_cast<uint128_t>(amount) * derivative.amount;
+         auto result = (num + underlying.amount - 1) / underlying.amount;
+         check(result <= asset::max_amount, "derivative amount overflow");
+         return static_cast<int64_t>(result);
+      }
+
       uint64_t primary_key()const { return derivative.symbol.code().raw(); }
 
       EOSLIB_SERIALIZE( currency_reserves, (derivative)(issuer)(underlying) )
@@ -4,6 +4,9 @@
  */
 #include <gxc.reserve/gxc.reserve.hpp>
 #include <gxclib/token.hpp>
+#include <gxclib/dispatcher.hpp>
+
+#include <map>
 
 using token = gxc::token_contract_mock;
 
@@ -22,10 +25,11 @@ void reserve::mint(extended_asset derivative, extended_asset underlying, std::ve
    };
 
    for (auto o : opts) {
-      check(option_is_valid(o.first), "not allowed to set option `" + o.first + "`"); 
+      check(option_is_valid(o.first), [&]{ return "not allowed to set option `" + o.first + "`"; });
    }
 
    check(underlying.contract == name("gxc"), "underlying asset should be system token");
+   check(derivative.quantity.amount > 0 && underlying.quantity.amount > 0, "must be positive quantity");
 
    reserves rsv(_self, derivative.contract.value);
    auto it = rsv.find(derivative.quantity.symbol.code().raw());
@@ -52,25 +56,64 @@ void reserve::claim(name owner, extended_asset value) {
    reserves rsv(_self, value.contract.value);
    const auto& it = rsv.get(value.quantity.symbol.code().raw(), "underlying asset not found");
 
-   auto ul_amount = get_float_amount(it.underlying);
-   auto de_amount = get_float_amount(it.derivative);
-
-   const auto ratio = ul_amount / de_amount;
-   auto claimed_amount = ratio * get_float_amount(value.quantity);
+   auto claimed_amount = it.to_underlying(value.quantity.amount);
    check(claimed_amount > 0, "minimum amount for claim not satisfied");
 
-   auto claimed_asset = asset(static_cast<int64_t>(claimed_amount * pow(10, it.underlying.symbol.precision())), it.underlying.symbol);
+   auto claimed_asset = asset(claimed_amount, it.underlying.symbol);
+
+   // adjust input amount, burn only what is needed for claimed amount
+   value.quantity.amount = it.to_derivative(claimed_amount);
+
+   // burn derivative and release underlying asset at once
+   token(_self).with(owner).redeem(owner, value, extended_asset(claimed_asset, system_account));
+}
+
+void reserve::claimmany(std::vector<claim_param> claims) {
+   check(claims.size(), "no claims requested");
+
+   const auto& token_value = claims.front().value;
+
+   reserves rsv(_self, token_value.contract.value);
+   const auto& it = rsv.get(token_value.quantity.symbol.code().raw(), "underlying asset not found");
+
+   // merge claims by owner
+   std::map<name, asset> amounts;
 
-   // adjust input amount
-   value.quantity.amount = static_cast<int64_t>(get_float_amount(claimed_asset) / ratio * pow(10, it.derivative.symbol.precision()));
+   for (const auto& c : claims) {
+      check(c.value.contract == token_value.contract && c.value.quantity.symbol == token_value.quantity.symbol,
+            "all claims should be of the same token");
+      check(c.value.quantity.amount > 0, "invalid quantity");
+
+      auto am = amounts.find(c.owner);
+      if (am == amounts.end())
+         amounts.emplace(c.owner, c.value.quantity);
+      else
+         am->second += c.value.quantity;
+   }
+
+   std::vector<token::redemption> params;
+   params.reserve(amounts.size());
+
+   // gxc.token burns derivative token of owners only with their authority
+   auto _token = token(_self);
+
+   for (const auto& am : amounts) {
+      require_auth(am.first);
+      _token.with(am.first);
+
+      auto claimed_amount = it.to_underlying(am.second.amount);
+      check(claimed_amount > 0, "minimum amount for claim not satisfied");
+
+      params.push_back({
+         am.first,
+         asset(it.to_derivative(claimed_amount), it.derivative.symbol),
+         asset(claimed_amount, it.underlying.symbol)
+      });
+   }
 
-   // transfer token
-   token(_self).transfer(owner, _self, value, "claim reserve");
-   token(_self).transfer(_self, basename(value.contract), value, "claim reserve");
-   token(token_account).burn(value, "claim reserve");
-   token(_self).transfer(_self, owner, extended_asset(claimed_asset, system_account), "claim reserve");
+   _token.redeemmany(token_value.contract, token_value.quantity.symbol.code(), params);
 }
 
 } /// namespace gxc
 
-EOSIO_DISPATCH(gxc::reserve, (mint)(claim))
+GXC_DISPATCH_SAFE(gxc::reserve, (mint)(claim)(claimmany))
@@ -9,6 +9,7 @@
 #include <eosio/time.hpp>
 #include <eosio/singleton.hpp>
 #include <gxclib/dispatcher.hpp>
+#include <gxclib/singleton.hpp>
 #include <gxclib/system.hpp>
 #include <gxclib/chain_types.hpp>
 #include <gxclib/exchange_state.hpp>
@@ -27,8 +28,8 @@ struct [[eosio::table("global"), eosio::contract("gxc.system")]] gxc_global_stat
    uint64_t total_ram_bytes_reserved = 0;
    int64_t  total_ram_stake = 0;
    uint16_t new_ram_per_block = 0;
-   block_timestamp last_ram_increase;
-   block_timestamp last_block_num;
+   block_timestamp last_ram_increase; // deprecated, moved to gxc_global_state2
+   block_timestamp last_block_num;    // deprecated, moved to gxc_global_state2
    uint8_t  revision = 0;
 
    EOSLIB_SERIALIZE_DERIVED(gxc_global_state, gxc::blockchain_parameters,
@@ -37,6 +38,17 @@ struct [[eosio::table("global"), eosio::contract("gxc.system")]] gxc_global_stat
    )
 };
 
+/**
+ * Fields updated on every block are kept apart from gxc_global_state,
+ * so that `onblock` does not rewrite the whole blockchain parameters.
+ */
+struct [[eosio::table("global2"), eosio::contract("gxc.system")]] gxc_global_state2 {
+   block_timestamp last_ram_increase;
+   block_timestamp last_block_num;
+
+   EOSLIB_SERIALIZE(gxc_global_state2, (last_ram_increase)(last_block_num))
+};
+
 class [[eosio::contract("gxc.system")]] system_contract : public contract {
 public:
    system_contract(name s, name code, datastream<const char*> ds);
@@ -101,7 +113,19 @@ public:
    void updtrevision(uint8_t revision) { check(false, "not activated action"); }
 
    [[eosio::action]]
-   void genaccount(name creator, name name, authority owner, authority active, std::string nickname);
+   void genaccount(name creator, name name, ignore<authority> owner, ignore<authority> active, ignore<std::string> nickname);
+
+   struct genaccount_param {
+      name        name;
+      authority   owner;
+      authority   active;
+      std::string nickname;
+
+      EOSLIB_SERIALIZE(genaccount_param, (name)(owner)(active)(nickname))
+   };
+
+   [[eosio::action]]
+   void genaccounts(name creator, ignore<std::vector<genaccount_param>> params);
 
    // native action handlers
    [[eosio::action]]
@@ -152,11 +176,26 @@ public:
       EOSLIB_SERIALIZE(abi_hash, (owner)(hash))
    };
 
+   /**
+    * Accounts created by `genaccounts`, whose nicknames are paid by the creator in bulk.
+    * Written before inline `newaccount` and erased by its handler, so that it is empty after transaction.
+    */
+   struct [[eosio::table("bulknick"), eosio::contract("gxc.system")]] bulk_nickname {
+      name account;
+
+      uint64_t primary_key()const { return account.value; }
+
+      EOSLIB_SERIALIZE(bulk_nickname, (account))
+   };
+
+   typedef eosio::multi_index<"bulknick"_n, bulk_nickname> bulk_nicknames;
+
 private:
-   using global_state_singleton = eosio::singleton<"global"_n, gxc_global_state>;
+   using global_state_singleton = gxc::cached_singleton<"global"_n, gxc_global_state>;
+   using global_state2_singleton = gxc::cached_singleton<"global2"_n, gxc_global_state2>;
    rammarket               _rammarket;
    global_state_singleton  _global;
-   gxc_global_state        _gstate;
+   global_state2_singleton _global2;
 
    static symbol get_core_symbol(const rammarket& rm) {
       auto itr = rm.find(ramcore_symbol.raw());
@@ -168,12 +207,16 @@ private:
       return (name == system_account) || has_dot(name);
    }
 
-   static gxc_global_state get_default_parameters();
+   static gxc_global_state get_default_parameters(name);
+   static gxc_global_state2 get_default_state2(name code);
 
    symbol core_symbol()const;
 
    void update_ram_supply();
 
+   void send_newaccount(const std::vector<permission_level>& auths, name creator, name name,
+                        std::string_view owner, std::string_view active);
+
    //defined in delegate_bandwidth.cpp
    void changebw( name from, name receiver,
                   asset stake_net_quantity, asset stake_cpu_quantity, bool transfer );
@@ -83,8 +83,7 @@ void system_contract::buyrambytes( name payer, name receiver, uint32_t bytes ) {
    check(false, "not activated action");
 
    auto itr = _rammarket.find(ramcore_symbol.raw());
-   auto tmp = *itr;
-   auto eosout = tmp.convert( asset(bytes, ram_symbol), core_symbol() );
+   auto eosout = itr->get_quote( asset(bytes, ram_symbol), core_symbol() );
 
    buyram( payer, receiver, eosout );
 }
@@ -131,8 +130,9 @@ void system_contract::buyram( name payer, name receiver, asset quant ) {
 
    check( bytes_out > 0, "must reserve a positive amount" );
 
-   _gstate.total_ram_bytes_reserved += uint64_t(bytes_out);
-   _gstate.total_ram_stake          += quant_after_fee.amount;
+   auto& gstate = _global.modify();
+   gstate.total_ram_bytes_reserved += uint64_t(bytes_out);
+   gstate.total_ram_stake          += quant_after_fee.amount;
 
    user_resources_table  userres( _self, receiver.value );
    auto res_itr = userres.find( receiver.value );
@@ -179,11 +179,12 @@ void system_contract::sellram( name account, int64_t bytes ) {
 
    check( tokens_out.amount > 1, "token amount received from selling ram is too low" );
 
-   _gstate.total_ram_bytes_reserved -= static_cast<decltype(_gstate.total_ram_bytes_reserved)>(bytes); // bytes > 0 is asserted above
-   _gstate.total_ram_stake          -= tokens_out.amount;
+   auto& gstate = _global.modify();
+   gstate.total_ram_bytes_reserved -= static_cast<decltype(gstate.total_ram_bytes_reserved)>(bytes); // bytes > 0 is asserted above
+   gstate.total_ram_stake          -= tokens_out.amount;
 
    //// this shouldn't happen, but just in case it does we should prevent it
-   check( _gstate.total_ram_stake >= 0, "error, attempt to unstake more tokens than previously staked" );
+   check( gstate.total_ram_stake >= 0, "error, attempt to unstake more tokens than previously staked" );
 
    userres.modify( res_itr, account, [&]( auto& res ) {
        res.ram_bytes -= bytes;
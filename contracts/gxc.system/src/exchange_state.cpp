@@ -4,19 +4,10 @@
  */
 #include <gxclib/exchange_state.hpp>
 
-#include <cmath>
-
 namespace gxc {
 
 asset exchange_state::convert_to_exchange( connector& c, asset in ) {
-   real_type R(supply.amount);
-   real_type C(c.balance.amount+in.amount);
-   real_type F(c.weight);
-   real_type T(in.amount);
-   real_type ONE(1.0);
-
-   real_type E = -R * (ONE - std::pow( ONE + T / C, F) );
-   int64_t issued = int64_t(E);
+   int64_t issued = get_exchange_out( supply.amount, c.balance.amount, in.amount );
 
    supply.amount += issued;
    c.balance.amount += in.amount;
@@ -27,20 +18,7 @@ asset exchange_state::convert_to_exchange( connector& c, asset in ) {
 asset exchange_state::convert_from_exchange( connector& c, asset in ) {
    eosio::check( in.symbol== supply.symbol, "unexpected asset symbol input" );
 
-   real_type R(supply.amount - in.amount);
-   real_type C(c.balance.amount);
-   real_type F(1.0/c.weight);
-   real_type E(in.amount);
-   real_type ONE(1.0);
-
-  // potentially more accurate:
-  // The functions std::expm1 and std::log1p are useful for financial calculations, for example,
-  // when calculating small daily interest rates: (1+x)n
-  // -1 can be expressed as std::expm1(n * std::log1p(x)).
-  // real_type T = C * std::expm1( F * std::log1p(E/R) );
-
-   real_type T = C * (std::pow( ONE + E/R, F) - ONE);
-   int64_t out = int64_t(T);
+   int64_t out = get_connector_out( supply.amount, c.balance.amount, in.amount );
 
    supply.amount -= in.amount;
    c.balance.amount -= out;
@@ -49,38 +27,28 @@ asset exchange_state::convert_from_exchange( connector& c, asset in ) {
 }
 
 asset exchange_state::convert( asset from, const symbol& to ) {
-   auto sell_symbol  = from.symbol;
-   auto ex_symbol    = supply.symbol;
-   auto base_symbol  = base.balance.symbol;
-   auto quote_symbol = quote.balance.symbol;
+   if( from.symbol != supply.symbol ) {
+      from = convert_to_exchange( get_connector( from.symbol, "invalid sell" ), from );
+      if( to == supply.symbol )
+         return from;
+   }
+   return convert_from_exchange( get_connector( to, "invalid conversion" ), from );
+}
 
-   //print( "From: ", from, " TO ", asset( 0,to), "\n" );
-   //print( "base: ", base_symbol, "\n" );
-   //print( "quote: ", quote_symbol, "\n" );
-   //print( "ex: ", supply.symbol, "\n" );
+asset exchange_state::get_quote( asset from, const symbol& to )const {
+   int64_t supply_amount = supply.amount;
 
-   if( sell_symbol != ex_symbol ) {
-      if( sell_symbol == base_symbol ) {
-         from = convert_to_exchange( base, from );
-      } else if( sell_symbol == quote_symbol ) {
-         from = convert_to_exchange( quote, from );
-      } else {
-         eosio::check( false, "invalid sell" );
-      }
-   } else {
-      if( to == base_symbol ) {
-         from = convert_from_exchange( base, from );
-      } else if( to == quote_symbol ) {
-         from = convert_from_exchange( quote, from );
-      } else {
-         eosio::check( false, "invalid conversion" );
-      }
+   if( from.symbol != supply.symbol ) {
+      const auto& c = get_connector( from.symbol, "invalid sell" );
+      int64_t issued = get_exchange_out( supply_amount, c.balance.amount, from.amount );
+      supply_amount += issued;
+      if( to == supply.symbol )
+         return asset( issued, supply.symbol );
+      from = asset( issued, supply.symbol );
    }
 
-   if( to != from.symbol )
-      return convert( from, to );
-
-   return from;
+   const auto& c = get_connector( to, "invalid conversion" );
+   return asset( get_connector_out( supply_amount, c.balance.amount, from.amount ), c.balance.symbol );
 }
 
 }
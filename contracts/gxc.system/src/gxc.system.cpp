@@ -10,20 +10,35 @@ namespace gxc {
 system_contract::system_contract(name s, name code, datastream<const char*> ds)
 : contract(s, code, ds)
 , _rammarket(_self, _self.value)
-, _global(_self, _self.value) {
-   _gstate = _global.exists() ? _global.get() : get_default_parameters();
-}
+, _global(_self, _self.value, &system_contract::get_default_parameters)
+, _global2(_self, _self.value, &system_contract::get_default_state2)
+{}
 
 system_contract::~system_contract() {
-   _global.set(_gstate, _self);
+   _global.flush(_self);
+   _global2.flush(_self);
 }
 
-gxc_global_state system_contract::get_default_parameters() {
+// takes code only to match cached_singleton::default_state_func
+gxc_global_state system_contract::get_default_parameters(name) {
    gxc_global_state dp;
    get_blockchain_parameters(dp);
    return dp;
 }
 
+gxc_global_state2 system_contract::get_default_state2(name code) {
+   gxc_global_state2 gs2;
+
+   // migrate per-block fields from legacy global state
+   eosio::singleton<"global"_n, gxc_global_state> global(code, code.value);
+   if (global.exists()) {
+      auto gs = global.get();
+      gs2.last_ram_increase = gs.last_ram_increase;
+      gs2.last_block_num    = gs.last_block_num;
+   }
+   return gs2;
+}
+
 symbol system_contract::core_symbol()const {
    const static auto sym = get_core_symbol( _rammarket );
    return sym;
@@ -32,11 +47,13 @@ symbol system_contract::core_symbol()const {
 void system_contract::setram( uint64_t max_ram_size ) {
    require_auth( _self );
 
-   check( _gstate.max_ram_size < max_ram_size, "ram may only be increased" ); /// decreasing ram might result market maker issues
+   auto& gstate = _global.modify();
+
+   check( gstate.max_ram_size < max_ram_size, "ram may only be increased" ); /// decreasing ram might result market maker issues
    check( max_ram_size < 1024ll*1024*1024*1024*1024, "ram size is unrealistic" );
-   check( max_ram_size > _gstate.total_ram_bytes_reserved, "attempt to set max below reserved" );
+   check( max_ram_size > gstate.total_ram_bytes_reserved, "attempt to set max below reserved" );
 
-   auto delta = int64_t(max_ram_size) - int64_t(_gstate.max_ram_size);
+   auto delta = int64_t(max_ram_size) - int64_t(gstate.max_ram_size);
    auto itr = _rammarket.find(ramcore_symbol.raw());
 
    /**
@@ -46,17 +63,20 @@ void system_contract::setram( uint64_t max_ram_size ) {
       m.base.balance.amount += delta;
    });
 
-   _gstate.max_ram_size = max_ram_size;
+   gstate.max_ram_size = max_ram_size;
 }
 
 void system_contract::update_ram_supply() {
    auto cbt = current_block_time();
 
-   if( cbt <= _gstate.last_ram_increase ) return;
+   if( cbt <= _global2.get().last_ram_increase ) return;
+
+   auto& gstate = _global.modify();
+   auto& gstate2 = _global2.modify();
 
    auto itr = _rammarket.find(ramcore_symbol.raw());
-   auto new_ram = (cbt.slot - _gstate.last_ram_increase.slot)*_gstate.new_ram_per_block;
-   _gstate.max_ram_size += new_ram;
+   auto new_ram = (cbt.slot - gstate2.last_ram_increase.slot)*gstate.new_ram_per_block;
+   gstate.max_ram_size += new_ram;
 
    /**
     *  Increase the amount of ram for sale based upon the change in max ram size.
@@ -64,7 +84,7 @@ void system_contract::update_ram_supply() {
    _rammarket.modify( itr, same_payer, [&]( auto& m ) {
       m.base.balance.amount += new_ram;
    });
-   _gstate.last_ram_increase = cbt;
+   gstate2.last_ram_increase = cbt;
 }
 
 /**
@@ -78,13 +98,14 @@ void system_contract::setramrate( uint16_t bytes_per_block ) {
    require_auth( _self );
 
    update_ram_supply();
-   _gstate.new_ram_per_block = bytes_per_block;
+   _global.modify().new_ram_per_block = bytes_per_block;
 }
 
 void system_contract::setparams( const gxc::blockchain_parameters& params ) {
    require_auth( _self );
-   (gxc::blockchain_parameters&)(_gstate) = params;
-   check( 3 <= _gstate.max_authority_depth, "max_authority_depth should be at least 3" );
+   auto& gstate = _global.modify();
+   (gxc::blockchain_parameters&)(gstate) = params;
+   check( 3 <= gstate.max_authority_depth, "max_authority_depth should be at least 3" );
    set_blockchain_parameters( params );
 }
 
@@ -115,7 +136,7 @@ void system_contract::init(unsigned_int version, symbol core) {
    _rammarket.emplace(_self, [&](auto& m) {
       m.supply.amount = 100'000'000'000'000ll;
       m.supply.symbol = ramcore_symbol;
-      m.base.balance.amount = int64_t(_gstate.free_ram());
+      m.base.balance.amount = int64_t(_global.get().free_ram());
       m.base.balance.symbol = ram_symbol;
       m.quote.balance.amount = system_token_supply.amount / 1000;
       m.quote.balance.symbol = core;
@@ -155,13 +176,69 @@ void system_contract::init(unsigned_int version, symbol core) {
    }
 }
 
-void system_contract::genaccount(name creator, name name, authority owner, authority active, std::string nickname) {
+void system_contract::send_newaccount(const std::vector<permission_level>& auths, name creator, name name,
+                                      std::string_view owner, std::string_view active) {
+   // authorities are forwarded as packed in action data, without deserializing them
+   action act;
+   act.account = _self;
+   act.name = "newaccount"_n;
+   act.authorization = auths;
+   act.data = pack(std::make_tuple(creator, name));
+   act.data.reserve(act.data.size() + owner.size() + active.size());
+   act.data.insert(act.data.end(), owner.begin(), owner.end());
+   act.data.insert(act.data.end(), active.begin(), active.end());
+   act.send();
+}
+
+void system_contract::genaccount(name creator, name name, ignore<authority> owner, ignore<authority> active, ignore<std::string> nickname) {
+   require_auth(creator);
+
+   auto _owner = read_authority_view(_ds);
+   auto _active = read_authority_view(_ds);
+   auto _nickname = std::string(read_view(_ds));
+
+   action({{_self, active_permission}}, user_account, "setnick"_n, std::make_tuple(name, _nickname)).send();
+   send_newaccount({{creator, active_permission}, {_self, active_permission}}, creator, name, _owner, _active);
+}
+
+void system_contract::genaccounts(name creator, ignore<std::vector<genaccount_param>> params) {
    require_auth(creator);
+   check(creator != _self, "system accounts cannot be created in bulk");
+
+   auto count = read_size(_ds);
+   check(count, "no accounts given");
+
+   std::vector<std::tuple<name, std::string>> nicknames;
+   nicknames.reserve(count);
+
+   std::vector<permission_level> auths = {{creator, active_permission}, {_self, active_permission}};
+
+   // tells newaccount handler that nickname is set in bulk below
+   bulk_nicknames bulk(_self, _self.value);
 
-   action({{_self, active_permission}}, user_account, "setnick"_n, std::make_tuple(name, nickname)).send();
-   action({{creator, active_permission}, {_self, active_permission}}, _self, "newaccount"_n,
-      std::make_tuple(creator, name, owner, active)
-   ).send();
+   for (uint32_t i = 0; i < count; ++i) {
+      name account;
+      _ds >> account;
+
+      auto owner = read_authority_view(_ds);
+      auto active = read_authority_view(_ds);
+
+      bulk.emplace(creator, [&](auto& b) {
+         b.account = account;
+      });
+      send_newaccount(auths, creator, account, owner, active);
+
+      nicknames.emplace_back(account, std::string(read_view(_ds)));
+   }
+
+   // new accounts do not exist yet when inline action is sent, so that creator pays for nicknames
+   action(auths, user_account, "setnicks"_n, std::make_tuple(creator, nicknames)).send();
 }
 
 }
+
+GXC_DISPATCH_SAFE(gxc::system_contract, (onblock)(init)(setalimits)(buyram)(buyrambytes)(sellram)(refund)
+                                         (delegatebw)(undelegatebw)(setram)(setramrate)(setparams)(setpriv)
+                                         (updtrevision)(genaccount)(genaccounts)
+                                         (newaccount)(updateauth)(deleteauth)(linkauth)(unlinkauth)
+                                         (canceldelay)(onerror)(setabi)(setcode))
@@ -16,7 +16,7 @@ void system_contract::onblock(ignore<block_header> header) {
    block_timestamp timestamp;
    _ds >> timestamp;
 
-   _gstate.last_block_num = timestamp;
+   _global2.modify().last_block_num = timestamp;
 }
 
 void system_contract::newaccount(name creator, name name, ignore<authority> owner, ignore<authority> active) {
@@ -36,7 +36,13 @@ void system_contract::newaccount(name creator, name name, ignore<authority> owne
 
       eosio::set_resource_limits(name, 0 + ram_gift_bytes, 0, 0);
 
-      action({{name, active_permission}}, user_account, "payram4nick"_n, name).send();
+      // nickname of accounts created by genaccounts is paid by the creator in bulk
+      bulk_nicknames bulk(_self, _self.value);
+      auto it = bulk.find(name.value);
+      if (it != bulk.end())
+         bulk.erase(it);
+      else
+         action({{name, active_permission}}, user_account, "payram4nick"_n, name).send();
    }
 }
 
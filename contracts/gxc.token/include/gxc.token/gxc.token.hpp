@@ -5,13 +5,24 @@
 #pragma once
 
 #include <gxc.token/config.hpp>
+#include <gxc.token/options.hpp>
 
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/permission.hpp>
+#include <eosio/singleton.hpp>
+
+#include <map>
+#include <optional>
+#include <algorithm>
 
 #include <gxclib/symbol.hpp>
 #include <gxclib/action.hpp>
+#include <gxclib/check.hpp>
+#include <gxclib/dispatcher.hpp>
 
 using namespace eosio;
 
@@ -25,24 +36,79 @@ namespace gxc {
       using contract::contract;
       using key_value = std::pair<std::string, std::vector<int8_t>>;
 
+      // v2 encoding of key_value, key is the value of option_key
+      struct option {
+         uint8_t key;
+         int64_t value;
+
+         option_key get_key()const { return static_cast<option_key>(key); }
+
+         EOSLIB_SERIALIZE(option, (key)(value))
+      };
+
+      struct transfer_param {
+         name        to;
+         asset       quantity;
+         std::string memo;
+
+         EOSLIB_SERIALIZE(transfer_param, (to)(quantity)(memo))
+      };
+
+      struct redemption {
+         name  owner;
+         asset quantity;   // derivative token to be burnt
+         asset underlying; // system token to be released
+
+         EOSLIB_SERIALIZE(redemption, (owner)(quantity)(underlying))
+      };
+
+      struct settlement {
+         name  from;
+         name  to;
+         asset quantity;
+
+         EOSLIB_SERIALIZE(settlement, (from)(to)(quantity))
+      };
+
       void regtoken(name issuer, symbol_code symbol, name contract);
 
       // ACTION LIST BEGIN
 
       [[eosio::action]]
-      void mint(extended_asset value, std::vector<key_value> opts);
+      void mint(extended_asset value, ignore<std::vector<key_value>> opts);
 
       [[eosio::action]]
-      void transfer(name from, name to, extended_asset value, std::string memo);
+      void transfer(name from, name to, extended_asset value, ignore<std::string> memo);
 
       [[eosio::action]]
-      void burn(extended_asset value, std::string memo);
+      void transfers(name from, name issuer, symbol_code symbol, std::vector<transfer_param> params);
 
       [[eosio::action]]
-      void setopts(name issuer, symbol_code symbol, std::vector<key_value> opts);
+      void settle(name issuer, symbol_code symbol, std::vector<settlement> params, ignore<std::string> memo);
 
       [[eosio::action]]
-      void setacntopts(name account, name issuer, symbol_code symbol, std::vector<key_value> opts);
+      void burn(extended_asset value, ignore<std::string> memo);
+
+      [[eosio::action]]
+      void redeem(name owner, extended_asset value, extended_asset underlying);
+
+      [[eosio::action]]
+      void redeemmany(name issuer, symbol_code symbol, std::vector<redemption> params);
+
+      [[eosio::action]]
+      void setopts(name issuer, symbol_code symbol, ignore<std::vector<key_value>> opts);
+
+      [[eosio::action]]
+      void setopts2(name issuer, symbol_code symbol, std::vector<option> opts);
+
+      [[eosio::action]]
+      void setacntopts(name account, name issuer, symbol_code symbol, ignore<std::vector<key_value>> opts);
+
+      [[eosio::action]]
+      void setacntopts2(name account, name issuer, symbol_code symbol, std::vector<option> opts);
+
+      [[eosio::action]]
+      void setacntsopts(name issuer, symbol_code symbol, std::vector<name> accounts, ignore<std::vector<key_value>> opts);
 
       [[eosio::action]]
       void open(name owner, name issuer, symbol_code symbol, name payer);
@@ -50,6 +116,12 @@ namespace gxc {
       [[eosio::action]]
       void close(name owner, name issuer, symbol_code symbol);
 
+      [[eosio::action]]
+      void subscribe(name owner, name issuer, symbol_code symbol);
+
+      [[eosio::action]]
+      void unsubscribe(name owner, name issuer, symbol_code symbol);
+
       [[eosio::action]]
       void deposit(name owner, extended_asset value);
 
@@ -62,9 +134,43 @@ namespace gxc {
       [[eosio::action]]
       void clrwithdraws(name owner);
 
+      [[eosio::action]]
+      void procwithdraws(uint32_t max_rows);
+
+      [[eosio::action]]
+      void syncgame(name issuer);
+
       [[eosio::action]]
       void approve(name owner, name spender, extended_asset value);
 
+      [[eosio::action]]
+      void permit(name owner, name spender, extended_asset value, uint64_t nonce, time_point_sec expiration,
+                  signature sig, ignore<std::string> memo);
+
+      [[eosio::action]]
+      void setchainid(checksum256 chain_id);
+
+      [[eosio::action]]
+      void openstream(name from, name to, extended_asset rate, time_point_sec start, time_point_sec end);
+
+      [[eosio::action]]
+      void claimstream(uint64_t id);
+
+      [[eosio::action]]
+      void closestream(uint64_t id);
+
+      [[eosio::action]]
+      void distribute(name issuer, symbol_code symbol, extended_asset reward);
+
+      [[eosio::action]]
+      void claimreward(name owner, name issuer, symbol_code symbol);
+
+      [[eosio::action]]
+      void countholders(name issuer, symbol_code symbol, std::vector<name> owners);
+
+      [[eosio::action]]
+      void migrate(std::vector<name> owners, uint32_t max_rows);
+
       // dummy actions
       [[eosio::action]]
       void withdraw(name owner, extended_asset value) { require_auth(_self); }
@@ -81,45 +187,115 @@ namespace gxc {
          return token_hash(reinterpret_cast<const char*>(&sym_code), sizeof(uint128_t));
       }
 
+      // Reward accrued per share up to `per_share` (scaled by 2^64), and not yet claimed.
+      // Scoped to owner, keyed by token id, and paid by token contract, since balance row is often paid by
+      // an account which doesn't authorize the action settling reward.
+      struct [[eosio::table("rewardcp"), eosio::contract("gxc.token")]] reward_checkpoint {
+         uint64_t  id;
+         uint128_t per_share = 0;
+         int64_t   unclaimed = 0;
+
+         uint64_t primary_key()const { return id; }
+
+         EOSLIB_SERIALIZE(reward_checkpoint, (id)(per_share)(unclaimed))
+      };
+
+      typedef multi_index<"rewardcp"_n, reward_checkpoint> reward_checkpoints;
+
+      // Reward distributed to holders in proportion to balance and deposit, accumulated per share (scaled by 2^64).
+      // Scoped to token contract, keyed by token id.
+      struct [[eosio::table("rewards"), eosio::contract("gxc.token")]] reward_pool {
+         uint64_t        id;
+         extended_symbol symbol;
+         uint128_t       per_share = 0;
+         int64_t         undistributed = 0; // remainder of per share division, carried to next distribution
+
+         uint64_t primary_key()const { return id; }
+
+         EOSLIB_SERIALIZE(reward_pool, (id)(symbol)(per_share)(undistributed))
+      };
+
+      typedef multi_index<"rewards"_n, reward_pool> rewards;
+
       // To reduce ram usage, some fields in a row of multi-index table store more than one type of info.
       // Do not access field with underscore suffix directly, but use accessor methods.
+      //
+      // Row layout v2 drops symbol and issuer implied by primary key, and deposit if it is zero.
+      // Legacy rows (v1: `asset balance`, `name issuer_` with opts, `int64_t deposit_`) are decoded by its size,
+      // and rewritten as v2 on next write or by `migrate` action.
+      // ABI describes only v2, so off-chain readers decode legacy rows wrongly until they are migrated.
       struct [[eosio::table("accounts"), eosio::contract("gxc.token")]] account_balance {
       public:
-         asset     balance;  // 16
+         int64_t   balance = 0; //  8
+         uint64_t  id;          // 16, token id
       private:
-         name      issuer_;  // 24, the lowest 4 bits assigned to opts
-         int64_t   deposit_; // 32
+         uint8_t   opts_ = 0;   // 17, the highest bit marks legacy row in memory
+         binary_extension<int64_t> deposit_; // 25, omitted if zero
 
       public:
+         static constexpr uint32_t legacy_size = 32;
+         static constexpr uint8_t  legacy_bit  = 0x80;
+
          enum opt {
             frozen = 0,
-            whitelist
+            whitelist,
+            notify,
+            counted // included in counters of token, set on creation or by `countholders`
          };
 
-         name issuer()const { return name(issuer_.value & ~MASK_4BITS); }
-         void issuer(name account) { issuer_ = name((issuer_.value & MASK_4BITS) | account.value); }
-
-         asset deposit()const { return asset(deposit_, balance.symbol); }
-         void deposit(const asset& quantity) {
-            check(quantity.symbol == balance.symbol, "symbol mismatch");
-            deposit_ = quantity.amount;
+         int64_t deposit()const { return deposit_.has_value() ? deposit_.value() : 0; }
+         void deposit(int64_t amount) {
+            if (amount) deposit_.emplace(amount);
+            else        deposit_.reset();
          }
 
-         bool option(opt n)const { return (issuer_.value >> (0 + n)) & 0x1; }
+         bool option(opt n)const { return (opts_ >> (0 + n)) & 0x1; }
          void option(opt n, bool val) {
-            if (val) issuer_.value |= 0x1 << n;
-            else     issuer_.value &= ~(0x1 << n);
+            if (val) opts_ |= 0x1 << n;
+            else     opts_ &= ~(0x1 << n);
          }
 
-         uint64_t primary_key()const { return get_token_id(extended_asset(balance, issuer())); }
-         uint64_t by_issuer()const   { return issuer().value; }
+         bool is_legacy()const { return opts_ & legacy_bit; }
+         void upgrade() { opts_ &= ~legacy_bit; }
+
+         uint64_t primary_key()const { return id; }
 
-         EOSLIB_SERIALIZE(account_balance, (balance)(issuer_)(deposit_))
+         template<typename DataStream>
+         friend DataStream& operator<<(DataStream& ds, const account_balance& a) {
+            ds << a.balance << a.id << static_cast<uint8_t>(a.opts_ & ~legacy_bit);
+            if (a.deposit()) ds << a.deposit();
+            return ds;
+         }
+
+         template<typename DataStream>
+         friend DataStream& operator>>(DataStream& ds, account_balance& a) {
+            a.deposit_.reset();
+
+            if (ds.remaining() == legacy_size) {
+               asset   balance;
+               name    issuer;
+               int64_t deposit;
+               ds >> balance >> issuer >> deposit;
+
+               a.balance = balance.amount;
+               a.id      = token_contract::get_token_id(extended_asset(balance, name(issuer.value & ~MASK_4BITS)));
+               a.opts_   = static_cast<uint8_t>(issuer.value & MASK_4BITS) | legacy_bit;
+               a.deposit(deposit);
+            } else {
+               ds >> a.balance >> a.id >> a.opts_;
+               if (ds.remaining()) {
+                  int64_t deposit;
+                  ds >> deposit;
+                  a.deposit(deposit);
+               }
+            }
+            return ds;
+         }
       };
 
-      typedef multi_index<"accounts"_n, account_balance,
-                 indexed_by<"issuer"_n, const_mem_fun<account_balance, uint64_t, &account_balance::by_issuer>>
-              > accounts;
+      // `issuer` secondary index has been dropped, legacy rows still have an entry of the index until rewritten
+      typedef multi_index<"accounts"_n, account_balance> accounts;
+      static constexpr uint64_t legacy_issuer_index = "accounts"_n.value & 0xFFFFFFFFFFFFFFF0ULL;
 
       struct [[eosio::table("stat"), eosio::contract("gxc.token")]] currency_stats {
          asset    supply;      // 16
@@ -135,6 +311,11 @@ namespace gxc {
          int64_t  withdraw_min_amount_; // 48
 
       public:
+         // Counters of account rows and deposit, set on mint or by `countholders` for tokens minted before.
+         // Only account rows marked as counted are included, so that backfill doesn't count a row twice.
+         binary_extension<uint64_t> holders;       // 56
+         binary_extension<int64_t>  total_deposit; // 64
+
          enum opt {
             mintable = 0,
             recallable,
@@ -142,9 +323,15 @@ namespace gxc {
             pausable,
             paused,
             whitelistable,
-            whitelist_on
+            whitelist_on,
+            game_issuer, // issuer is registered in gxc.game, valid only if game_synced
+            game_synced, // game_issuer is maintained by syncgame, unset for virtual issuer and legacy token
+            rewarded     // reward pool exists in `rewards`
          };
 
+         // Virtual issuer (e.g. `game.item`) follows registration of its base account, so it is not cached
+         static bool is_game_cacheable(name issuer) { return basename(issuer) == issuer; }
+
          asset max_supply()const { return asset(max_supply_, supply.symbol); }
          void max_supply(const asset& quantity) {
             check(quantity.symbol == supply.symbol, "symbol mismatch");
@@ -167,11 +354,14 @@ namespace gxc {
          uint64_t primary_key()const { return supply.symbol.code().raw(); }
 
          EOSLIB_SERIALIZE(currency_stats, (supply)(max_supply_)(issuer)(opts_)
-                                          (withdraw_delay_sec)(withdraw_min_amount_))
+                                          (withdraw_delay_sec)(withdraw_min_amount_)
+                                          (holders)(total_deposit))
       };
 
       typedef multi_index<"stat"_n, currency_stats> stat;
 
+      // Not compacted as `accounts` is, since the queue and `procwithdraws` read symbol and issuer from the row
+      // without the owner's balance row to restore them from token id.
       struct [[eosio::table("withdraws"), eosio::contract("gxc.token")]] withdrawal_request {
          asset          quantity;
          name           issuer;
@@ -189,10 +379,39 @@ namespace gxc {
                  indexed_by<"schedtime"_n, const_mem_fun<withdrawal_request, uint64_t, &withdrawal_request::by_scheduled_time>>
               > withdraws;
 
+      // Contract-wide queue of withdrawal requests ordered by scheduled time, scoped to token contract
+      struct [[eosio::table("withdrawq"), eosio::contract("gxc.token")]] withdrawal_queue {
+         name           owner;
+         uint64_t       request_id;
+         time_point_sec scheduled_time;
+
+         static uint64_t get_queue_id(name owner, uint64_t request_id) {
+            std::array<char,16> raw;
+            datastream<char*> ds(raw.data(), raw.size());
+            ds << owner;
+            ds << request_id;
+            return token_hash(raw.data(), raw.size());
+         }
+
+         uint64_t primary_key()const       { return get_queue_id(owner, request_id); }
+         uint64_t by_scheduled_time()const { return static_cast<uint64_t>(scheduled_time.utc_seconds); }
+
+         EOSLIB_SERIALIZE(withdrawal_queue, (owner)(request_id)(scheduled_time))
+      };
+
+      typedef multi_index<"withdrawq"_n, withdrawal_queue,
+                 indexed_by<"schedtime"_n, const_mem_fun<withdrawal_queue, uint64_t, &withdrawal_queue::by_scheduled_time>>
+              > withdrawq;
+
+      // Row layout v2 stores token id instead of symbol and issuer.
+      // Legacy rows (v1: `name spender`, `asset quantity`, `name issuer`) are decoded by its size.
+      // As with `accounts`, off-chain readers using ABI need legacy rows migrated.
       struct [[eosio::table("allowance"), eosio::contract("gxc.token")]] allowance {
-         name  spender;  //  8
-         asset quantity; // 24
-         name  issuer;   // 32
+         name     spender; //  8
+         int64_t  amount;  // 16
+         uint64_t id;      // 24, approval id
+
+         static constexpr uint32_t legacy_size = 32;
 
          static uint64_t get_approval_id(name spender, extended_asset value) {
             std::array<char,24> raw;
@@ -203,18 +422,93 @@ namespace gxc {
             return token_hash(raw.data(), raw.size());
          }
 
-         inline extended_asset value()const { return extended_asset(quantity, issuer); }
+         uint64_t primary_key()const { return id; }
 
-         uint64_t primary_key()const { return get_approval_id(spender, extended_asset(quantity, issuer)); }
+         template<typename DataStream>
+         friend DataStream& operator<<(DataStream& ds, const allowance& a) {
+            return ds << a.spender << a.amount << a.id;
+         }
 
-         EOSLIB_SERIALIZE(allowance, (spender)(quantity)(issuer))
+         template<typename DataStream>
+         friend DataStream& operator>>(DataStream& ds, allowance& a) {
+            if (ds.remaining() == legacy_size) {
+               asset quantity;
+               name  issuer;
+               ds >> a.spender >> quantity >> issuer;
+
+               a.amount = quantity.amount;
+               a.id     = allowance::get_approval_id(a.spender, extended_asset(quantity, issuer));
+            } else {
+               ds >> a.spender >> a.amount >> a.id;
+            }
+            return ds;
+         }
       };
 
       typedef multi_index<"allowance"_n, allowance> allowed;
 
+      // Used nonces of permit, 64 nonces per row, scoped to owner
+      struct [[eosio::table("nonces"), eosio::contract("gxc.token")]] nonce_bitmap {
+         uint64_t word;
+         uint64_t bits = 0;
+
+         uint64_t primary_key()const { return word; }
+
+         EOSLIB_SERIALIZE(nonce_bitmap, (word)(bits))
+      };
+
+      typedef multi_index<"nonces"_n, nonce_bitmap> nonces;
+
+      // Token streamed from `from` to `to` by `rate` per second during [start, end), escrowed by token contract.
+      // Accrued amount is computed on read, and the row is written only when claimed or closed.
+      struct [[eosio::table("streams"), eosio::contract("gxc.token")]] stream {
+         uint64_t       id;
+         name           from;
+         name           to;
+         extended_asset rate;
+         time_point_sec start;
+         time_point_sec end;
+         int64_t        claimed = 0;
+
+         int64_t total()const { return rate.quantity.amount * (end.utc_seconds - start.utc_seconds); }
+
+         extended_asset claimable(time_point_sec now)const {
+            auto until = std::min(now, end);
+            int64_t elapsed = (until > start) ? until.utc_seconds - start.utc_seconds : 0;
+            return extended_asset(asset(rate.quantity.amount * elapsed - claimed, rate.quantity.symbol), rate.contract);
+         }
+
+         uint64_t primary_key()const { return id; }
+
+         EOSLIB_SERIALIZE(stream, (id)(from)(to)(rate)(start)(end)(claimed))
+      };
+
+      typedef multi_index<"streams"_n, stream> streams;
+
+      // Chain id is not available to contract, so it is configured to bind permit to this chain
+      struct [[eosio::table("chainid"), eosio::contract("gxc.token")]] chain_info {
+         checksum256 chain_id;
+
+         EOSLIB_SERIALIZE(chain_info, (chain_id))
+      };
+
+      typedef eosio::singleton<"chainid"_n, chain_info> chain_info_singleton;
+
+      static checksum256 get_chain_id(name code) {
+         chain_info_singleton _chain(code, code.value);
+         check(_chain.exists(), "chain id is not configured");
+         return _chain.get().chain_id;
+      }
+
+      static checksum256 get_permit_digest(name code, name owner, name spender, extended_asset value,
+                                           uint64_t nonce, time_point_sec expiration) {
+         auto data = pack(std::make_tuple(get_chain_id(code), code, owner, spender, value, nonce, expiration));
+         return sha256(data.data(), data.size());
+      }
+
    private:
       static void check_asset_is_valid(asset quantity, bool zeroable = false) {
-         check(quantity.symbol.is_valid(), "invalid symbol name `" + quantity.symbol.code().to_string() + "`");
+         check(quantity.symbol.is_valid(), [&]{ return "invalid symbol name `" + quantity.symbol.code().to_string() + "`"; });
          check(quantity.is_valid(), "invalid quantity");
          if (zeroable)
             check(quantity.amount >= 0, "must not be negative quantity");
@@ -226,9 +520,27 @@ namespace gxc {
          check_asset_is_valid(value.quantity, zeroable);
       }
 
+      // Decodes `std::vector<key_value>` from action data without copying keys and values
+      template<typename Stream>
+      static std::vector<option> read_options(Stream& ds) {
+         auto count = read_size(ds);
+
+         std::vector<option> res;
+         res.reserve(count);
+         for (uint32_t i = 0; i < count; ++i) {
+            auto key = read_view(ds);
+            auto raw = read_view(ds);
+            auto k = to_option_key(key);
+            check(k != option_key::unknown, [&]{ return "unknown option `" + std::string(key) + "`"; });
+            res.push_back({static_cast<uint8_t>(k), to_option_value(raw)});
+         }
+         return res;
+      }
+
       class token;
       class account;
       class requests;
+      class payouts;
 
       class token : public multi_index_wrapper<stat> {
       public:
@@ -246,36 +558,103 @@ namespace gxc {
          : token(code, value.contract, value.quantity.symbol)
          {}
 
-         void mint(extended_asset value, const std::vector<key_value>& opts);
-         void setopts(const std::vector<key_value>& opts);
+         void mint(extended_asset value, const std::vector<option>& opts);
+         void setopts(const std::vector<option>& opts);
+         void setacntsopts(const std::vector<name>& accounts, const std::vector<option>& opts);
          void issue(name to, extended_asset quantity);
          void burn(extended_asset quantity);
+         void redeem(name owner, extended_asset quantity);
+         void redeem(const std::vector<redemption>& params);
          void retire(name owner, extended_asset quantity);
          void transfer(name from, name to, extended_asset quantity);
+         void transfer(name from, const std::vector<transfer_param>& params);
+         void settle(const std::vector<settlement>& params);
          void deposit(name owner, extended_asset value);
          void withdraw(name owner, extended_asset value);
          void cancel_withdraw(name owner, name issuer, symbol_code symbol);
-
-         account get_account(name owner)const {
+         void permit(name owner, name spender, extended_asset value, uint64_t nonce, time_point_sec expiration,
+                     const signature& sig);
+         void open_stream(name from, name to, extended_asset rate, time_point_sec start, time_point_sec end);
+         void claim_stream(streams& table, const stream& s);
+         void close_stream(streams& table, const stream& s);
+         void distribute(extended_asset reward);
+         void claim_reward(name owner);
+
+         account get_account(name owner) {
             check(exists(), "token not found");
-            return account(code(), owner, get_token_id(extended_asset(asset(0, _this->supply.symbol), _this->issuer)), *this);           
+            return account(code(), owner, token_id(), *this);
+         }
+
+         uint64_t token_id()const {
+            return get_token_id(extended_asset(asset(0, _this->supply.symbol), _this->issuer));
          }
 
          inline name issuer()const { return scope(); }
 
+         static void sync_game(name code, name issuer);
+
+         void update_stats(int64_t holders, int64_t deposit);
+         void count_holders(const std::vector<name>& owners);
+
+         inline bool is_counting()const { return _this->holders.has_value(); }
+
+         // Runs `changes` of accounts with counter updates deferred, and writes them with `updater` at once
+         template<typename Changes, typename Updater>
+         void modify_with_stats(Changes&& changes, Updater&& updater) {
+            _defer_stats = true;
+            changes();
+            _defer_stats = false;
+
+            modify(same_payer, [&](auto& s) {
+               updater(s);
+               apply_stats(s);
+            });
+         }
+
+         // tokens without reward don't look up `rewards` on balance change
+         inline bool has_reward()const { return _this->option(opt::rewarded); }
+         const reward_pool& get_reward()const;
+
       private:
-         void _setopts(const std::vector<key_value>& opts, bool init = false);
+         static void _setopts(currency_stats& t, const std::vector<option>& opts, bool init = false);
+
+         void pay_from_escrow(name to, extended_asset value, name payer);
+
+         mutable std::optional<reward_pool> _reward;
+
+         bool    _defer_stats = false;
+         int64_t _holders_delta = 0;
+         int64_t _deposit_delta = 0;
+
+         void apply_stats(currency_stats& s);
       };
 
       class account : public multi_index_wrapper<accounts> {
       public:
          using opt = account_balance::opt;
 
-         account(name code, name scope, uint64_t key, const token& st)
+         account(name code, name scope, uint64_t key, token& st)
          : multi_index_wrapper(code, scope, key)
          , _st(st)
+         , _id(key)
          {}
 
+         // Writes are done through below methods, so that legacy row drops its index entry when rewritten as v2.
+         template<typename Lambda>
+         void modify(name payer, Lambda&& updater) {
+            drop_legacy_index();
+            multi_index_wrapper::modify(payer, [&](auto& a) {
+               a.upgrade();
+               updater(a);
+            });
+         }
+
+         void erase() {
+            drop_legacy_index();
+            erase_checkpoint();
+            multi_index_wrapper::erase();
+         }
+
          void check_account_is_valid() {
             if (code() != owner()) {
                check(!_this->option(opt::frozen), "account is frozen");
@@ -283,16 +662,33 @@ namespace gxc {
             }
          }
 
-         void setopts(const std::vector<key_value>& opts);
+         // whether funds can be credited without authority of issuer and notification to owner
+         bool is_payable() {
+            if (code() == owner()) return true;
+            if (!exists()) return !_st->option(token::opt::whitelist_on);
+            return !_this->option(opt::frozen) && !_this->option(opt::notify) &&
+                   (!_st->option(token::opt::whitelist_on) || _this->option(opt::whitelist));
+         }
+
+         void setopts(const std::vector<option>& opts);
          void open();
          void close();
+         void subscribe(bool on);
          void approve(name spender, extended_asset value);
+         void use_nonce(uint64_t nonce, name payer);
 
          inline name owner()const  { return scope(); }
          inline name issuer()const { return _st.scope(); }
 
          inline const token& get_token()const { return _st; }
 
+         asset balance()const { return asset(_this->balance, _st->supply.symbol); }
+         asset deposit()const { return asset(_this->deposit(), _st->supply.symbol); }
+
+         int64_t accrued_reward()const;
+
+         static uint32_t migrate(name code, name owner, uint32_t max_rows);
+
          account& keep() {
             keep_balance = true;
             return *this;
@@ -309,18 +705,35 @@ namespace gxc {
          }
 
       private:
-         const token& _st;
+         token& _st;
+         uint64_t _id;
          bool  keep_balance;
          name  ram_payer = eosio::same_payer;
 
+         void drop_legacy_index() {
+            if (exists() && _this->is_legacy())
+               remove_legacy_index(code(), owner(), _id);
+         }
+
+         static void remove_legacy_index(name code, name owner, uint64_t id);
+
+         reward_checkpoint get_checkpoint()const;
+         void set_checkpoint(int64_t unclaimed);
+         void erase_checkpoint();
+         void checkpoint_reward();
+         int64_t take_reward();
          void sub_balance(extended_asset value);
          void add_balance(extended_asset value);
          void sub_deposit(extended_asset value);
          void add_deposit(extended_asset value);
          void sub_allowance(name spender, extended_asset value);
+         asset recall(extended_asset value);
+         void _setopts(const std::vector<option>& opts, bool strict = true);
+         opt to_opt(option_key key)const;
 
          friend class token;
          friend class requests;
+         friend class payouts;
       };
 
       class requests : public multi_index_wrapper<withdraws> {
@@ -331,10 +744,35 @@ namespace gxc {
          : multi_index_wrapper(code, scope, get_token_id(value))
          {}
 
-         void refresh_schedule();
+         void schedule();
+         void unschedule();
+         void unschedule(uint64_t request_id);
+         void pay_out(payouts& batch);
+         void pay_out(const withdrawal_request& rq, payouts& batch);
          void clear();
+         uint32_t enqueue_legacy(name payer, uint32_t max_rows);
+
+         static void process_queue(name code, uint32_t max_rows);
 
          inline name owner()const  { return scope(); }
       };
+
+      // Action-scoped cache of token rows for paying out withdrawal requests.
+      // Amounts paid out from token contract are combined, and its balance is written once per token.
+      class payouts {
+      public:
+         payouts(name code)
+         : _code(code)
+         {}
+
+         token& get_token(const extended_asset& value);
+         void add(const extended_asset& value);
+         void flush();
+
+      private:
+         name _code;
+         std::map<uint64_t, token> _tokens;
+         std::map<uint64_t, extended_asset> _debits;
+      };
    };
 }
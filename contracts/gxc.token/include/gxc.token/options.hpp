@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @copyright defined in gxc/LICENSE
+ */
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <boost/preprocessor/seq/enum.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+#include <cstring>
+#include <string_view>
+
+// Order of options defines the value of key in v2 encoding, append new option only at the end.
+#define GXC_TOKEN_OPTIONS \
+   (paused)(whitelist_on)(mintable)(recallable)(freezable)(pausable)(whitelistable) \
+   (withdraw_min_amount)(withdraw_delay_sec)(frozen)(whitelist)
+
+namespace gxc {
+
+   enum class option_key : uint8_t {
+      BOOST_PP_SEQ_ENUM(GXC_TOKEN_OPTIONS),
+      unknown
+   };
+
+   constexpr uint64_t option_hash(std::string_view key) {
+      // FNV-1a
+      uint64_t h = 0xcbf29ce484222325ull;
+      for (auto c : key) {
+         h ^= static_cast<uint8_t>(c);
+         h *= 0x100000001b3ull;
+      }
+      return h;
+   }
+
+#define GXC_TOKEN_OPTION_NAME( r, _, elem ) BOOST_PP_STRINGIZE(elem),
+
+   constexpr std::string_view option_names[] = {
+      BOOST_PP_SEQ_FOR_EACH( GXC_TOKEN_OPTION_NAME, _, GXC_TOKEN_OPTIONS )
+      "unknown"
+   };
+
+#undef GXC_TOKEN_OPTION_NAME
+
+   constexpr std::string_view option_name(option_key key) {
+      return (key < option_key::unknown) ? option_names[static_cast<uint8_t>(key)] : "unknown";
+   }
+
+   // Each case label is a hash computed at compile time; hash collision among options fails to compile.
+#define GXC_TOKEN_OPTION_CASE( r, _, elem ) \
+   case option_hash(BOOST_PP_STRINGIZE(elem)): \
+      return key == BOOST_PP_STRINGIZE(elem) ? option_key::elem : option_key::unknown;
+
+   /**
+    * Decodes legacy string key of option.
+    *
+    * @param key - the name of option
+    * @return option_key::unknown if not found
+    */
+   constexpr option_key to_option_key(std::string_view key) {
+      switch (option_hash(key)) {
+         BOOST_PP_SEQ_FOR_EACH( GXC_TOKEN_OPTION_CASE, _, GXC_TOKEN_OPTIONS )
+      }
+      return option_key::unknown;
+   }
+
+#undef GXC_TOKEN_OPTION_CASE
+
+   static_assert(to_option_key("whitelist_on") == option_key::whitelist_on);
+   static_assert(to_option_key("whitelist_of") == option_key::unknown);
+   static_assert(option_name(option_key::withdraw_delay_sec) == "withdraw_delay_sec");
+
+   /**
+    * Decodes legacy value of option, packed `bool` (1 byte) or `int64_t`/`uint64_t` (8 bytes).
+    */
+   inline int64_t to_option_value(std::string_view raw) {
+      if (raw.size() == 1)
+         return static_cast<int8_t>(raw[0]);
+
+      eosio::check(raw.size() == sizeof(int64_t), "invalid size of option value");
+      int64_t value;
+      std::memcpy(&value, raw.data(), sizeof(int64_t));
+      return value;
+   }
+}
@@ -6,41 +6,112 @@
 
 namespace gxc {
 
-   void token_contract::account::setopts(const std::vector<key_value>& opts) {
+   void token_contract::account::setopts(const std::vector<option>& opts) {
       check(opts.size(), "no changes on options");
       require_vauth(issuer());
 
+      _setopts(opts);
+   }
+
+   void token_contract::account::_setopts(const std::vector<option>& opts, bool strict) {
       modify(ram_payer, [&](auto& a) {
-         for (auto o : opts) {
-            if (o.first == "frozen") {
-               check(_st->option(token::opt::freezable), "not configured to freeze account");
-               auto value = unpack<bool>(o.second);
-               check(a.option(opt::frozen) != value, "option already has give value");
-               a.option(opt::frozen, value);
-            } else if (o.first == "whitelist") {
-               check(_st->option(token::opt::whitelistable), "not configured to whitelist account");
-               auto value = unpack<bool>(o.second);
-               check(a.option(opt::whitelist) != value, "option already has give value");
-               a.option(opt::whitelist, value);
-            } else {
-               check(false, "unknown option `" + o.first + "`");
-            }
+         for (const auto& o : opts) {
+            auto n = to_opt(o.get_key());
+            bool value = o.value;
+            check(!strict || a.option(n) != value, "option already has give value");
+            a.option(n, value);
          }
       });
    }
 
+   token_contract::account::opt token_contract::account::to_opt(option_key key)const {
+      switch (key) {
+      case option_key::frozen:
+         check(_st->option(token::opt::freezable), "not configured to freeze account");
+         return opt::frozen;
+      case option_key::whitelist:
+         check(_st->option(token::opt::whitelistable), "not configured to whitelist account");
+         return opt::whitelist;
+      default:
+         check(false, [&]{ return "unknown option `" + std::string(option_name(key)) + "`"; });
+      }
+      return opt::frozen; // control flow should not reach here
+   }
+
+   int64_t token_contract::account::accrued_reward()const {
+      if (!_st.has_reward() || owner() == code()) return 0;
+
+      auto r = get_checkpoint();
+      if (!exists()) return r.unclaimed;
+
+      // shares * delta / 2^64, split not to overflow 128 bits
+      uint128_t delta = _st.get_reward().per_share - r.per_share;
+      uint128_t shares = static_cast<uint64_t>(_this->balance + _this->deposit());
+      uint128_t accrued = (delta >> 64) * shares + ((static_cast<uint64_t>(delta) * shares) >> 64);
+      return r.unclaimed + static_cast<int64_t>(accrued);
+   }
+
+   token_contract::reward_checkpoint token_contract::account::get_checkpoint()const {
+      reward_checkpoints _checkpoints(code(), owner().value);
+      auto it = _checkpoints.find(_id);
+      return it != _checkpoints.end() ? *it : reward_checkpoint{_id};
+   }
+
+   void token_contract::account::set_checkpoint(int64_t unclaimed) {
+      auto update = [&](auto& r) {
+         r.id = _id;
+         r.per_share = _st.get_reward().per_share;
+         r.unclaimed = unclaimed;
+      };
+
+      reward_checkpoints _checkpoints(code(), owner().value);
+      auto it = _checkpoints.find(_id);
+      if (it == _checkpoints.end())
+         _checkpoints.emplace(code(), update);
+      else
+         _checkpoints.modify(it, same_payer, update);
+   }
+
+   void token_contract::account::erase_checkpoint() {
+      if (!_st.has_reward()) return;
+
+      reward_checkpoints _checkpoints(code(), owner().value);
+      auto it = _checkpoints.find(_id);
+      if (it != _checkpoints.end())
+         _checkpoints.erase(it);
+   }
+
+   // Settles reward accrued so far, should be called before the shares of row change
+   void token_contract::account::checkpoint_reward() {
+      if (!_st.has_reward() || owner() == code()) return;
+
+      // nothing accrued since the last checkpoint
+      if (get_checkpoint().per_share == _st.get_reward().per_share) return;
+      set_checkpoint(accrued_reward());
+   }
+
+   int64_t token_contract::account::take_reward() {
+      auto value = accrued_reward();
+      if (value) set_checkpoint(0);
+      return value;
+   }
+
    void token_contract::account::sub_balance(extended_asset value) {
       check_account_is_valid();
-      check(_this->balance.amount >= value.quantity.amount, "overdrawn balance");
+      check(_this->balance >= value.quantity.amount, "overdrawn balance");
 
-      if (!_this->option(opt::whitelist) && !keep_balance &&
-          _this->balance.amount == value.quantity.amount &&
-          _this->deposit().amount == 0)
+      if (!_this->option(opt::whitelist) && !_this->option(opt::notify) && !keep_balance &&
+          _this->balance == value.quantity.amount &&
+          _this->deposit() == 0 &&
+          !accrued_reward())
       {
+         bool counted = _this->option(opt::counted);
          erase();
+         if (counted) _st.update_stats(-1, 0);
       } else {
+         checkpoint_reward();
          modify(ram_payer, [&](auto& a) {
-            a.balance -= value.quantity;
+            a.balance -= value.quantity.amount;
          });
       }
    }
@@ -48,65 +119,134 @@ namespace gxc {
    void token_contract::account::add_balance(extended_asset value) {
       if (!exists()) {
          check(!_st->option(token::opt::whitelist_on) || has_vauth(value.contract), "required to open balance manually");
+         checkpoint_reward();
          emplace(ram_payer, [&](auto& a) {
-            a.balance = value.quantity;
-            a.deposit(asset(0, value.quantity.symbol));
-            a.issuer(value.contract);
+            a.balance = value.quantity.amount;
+            a.id      = _id;
+            a.option(opt::counted, _st.is_counting());
          });
+         _st.update_stats(1, 0);
       } else {
          check_account_is_valid();
+         checkpoint_reward();
          modify(ram_payer, [&](auto& a) {
-            a.balance += value.quantity;
+            a.balance += value.quantity.amount;
          });
+
+         if (_this->option(opt::notify))
+            require_recipient(owner());
       }
    }
 
    void token_contract::account::sub_deposit(extended_asset value) {
       check_account_is_valid();
-      check(_this->deposit().amount >= value.quantity.amount, "overdrawn deposit");
+      check(_this->deposit() >= value.quantity.amount, "overdrawn deposit");
 
-      if (!_this->option(opt::whitelist) && !keep_balance &&
-          _this->deposit().amount == value.quantity.amount &&
-          _this->balance.amount == 0)
+      if (!_this->option(opt::whitelist) && !_this->option(opt::notify) && !keep_balance &&
+          _this->deposit() == value.quantity.amount &&
+          _this->balance == 0 &&
+          !accrued_reward())
       {
+         bool counted = _this->option(opt::counted);
          erase();
+         if (counted) _st.update_stats(-1, -value.quantity.amount);
       } else {
+         checkpoint_reward();
          modify(ram_payer, [&](auto& a) {
-            a.deposit(a.deposit() - value.quantity);
+            a.deposit(a.deposit() - value.quantity.amount);
          });
+         if (_this->option(opt::counted)) _st.update_stats(0, -value.quantity.amount);
       }
    }
 
    void token_contract::account::add_deposit(extended_asset value) {
       if (!exists()) {
          check(!_st->option(token::opt::whitelist_on) || has_vauth(value.contract), "required to open deposit manually");
+         checkpoint_reward();
          emplace(ram_payer, [&](auto& a) {
-            a.balance = asset(0, value.quantity.symbol);
-            a.deposit(value.quantity);
-            a.issuer(value.contract);
+            a.id = _id;
+            a.deposit(value.quantity.amount);
+            a.option(opt::counted, _st.is_counting());
          });
+         _st.update_stats(1, value.quantity.amount);
       } else {
          check_account_is_valid();
+         checkpoint_reward();
          modify(ram_payer, [&](auto& a) {
-            a.deposit(a.deposit() + value.quantity);
+            a.deposit(a.deposit() + value.quantity.amount);
+         });
+         if (_this->option(opt::counted)) _st.update_stats(0, value.quantity.amount);
+
+         if (_this->option(opt::notify))
+            require_recipient(owner());
+      }
+   }
+
+   asset token_contract::account::recall(extended_asset value) {
+      paid_by(code());
+
+      // normal case, transfer owner's deposit
+      if (deposit() >= value.quantity) {
+         sub_deposit(value);
+         return asset(0, value.quantity.symbol);
+      }
+
+      // exceptional case, cached amount is not enough
+      // so withdrawal request is partially cancelled
+      auto leftover = value.quantity - deposit();
+      auto _req = requests(code(), owner(), value);
+      check(_req, "overdrawn deposit, but no withdrawal request");
+      check(_req->quantity >= leftover, "overdrawn deposit, but not enough withdrawal requested amount");
+
+      if (_req->quantity > leftover) {
+         _req.modify(same_payer, [&](auto& rq) {
+            rq.quantity -= leftover;
          });
+      } else {
+         _req.unschedule();
+         _req.erase();
       }
+      sub_deposit(extended_asset(deposit(), value.contract));
+
+      withdraw_reverted(code(), {code(), active_permission}).send(owner(), extended_asset(leftover, value.contract));
+
+      // reverted amount is held by token contract, caller should subtract it
+      return leftover;
    }
 
    void token_contract::account::open() {
       if (!exists()) {
          emplace(ram_payer, [&](auto& a) {
-            a.balance.symbol = _st->supply.symbol;
-            a.issuer(_st->issuer);
+            a.id = _id;
+            a.option(opt::counted, _st.is_counting());
          });
+         _st.update_stats(1, 0);
       }
    }
 
+   void token_contract::account::subscribe(bool on) {
+      require_auth(owner());
+
+      if (!exists()) {
+         check(on, "account balance doesn't exist");
+         paid_by(owner()).open();
+      }
+
+      check(_this->option(opt::notify) != on, on ? "already subscribed" : "not subscribed");
+
+      modify(ram_payer, [&](auto& a) {
+         a.option(opt::notify, on);
+      });
+   }
+
    void token_contract::account::close() {
       require_auth(owner());
       check(exists(), "account balance doesn't exist");
-      check(!_this->balance.amount && !_this->deposit().amount, "cannot close non-zero balance");
+      check(!_this->balance && !_this->deposit(), "cannot close non-zero balance");
+      check(!accrued_reward(), "cannot close with unclaimed reward");
+      bool counted = _this->option(opt::counted);
       erase();
+      if (counted) _st.update_stats(-1, 0);
    }
 
    void token_contract::account::approve(name spender, extended_asset value) {
@@ -121,13 +261,13 @@ namespace gxc {
          check(value.quantity.amount > 0, "allowance not found");
 
          _allowed.emplace(owner(), [&](auto& a) {
-            a.spender  = spender;
-            a.quantity = value.quantity;
-            a.issuer   = value.contract;
+            a.spender = spender;
+            a.amount  = value.quantity.amount;
+            a.id      = allowance::get_approval_id(spender, value);
          });
       } else if (value.quantity.amount > 0) {
          _allowed.modify(it, owner(), [&](auto& a) {
-            a.quantity = value.quantity;
+            a.amount = value.quantity.amount;
          });
       } else {
          _allowed.erase(it);
@@ -139,13 +279,67 @@ namespace gxc {
 
       const auto& it = _allowed.get(allowance::get_approval_id(spender, value));
 
-      if (it.quantity > value.quantity)
+      if (it.amount > value.quantity.amount)
          _allowed.modify(it, owner(), [&](auto& a) {
-            a.quantity -= value.quantity;
+            a.amount -= value.quantity.amount;
          });
-      else if (it.quantity == value.quantity)
+      else if (it.amount == value.quantity.amount)
          _allowed.erase(it);
       else
          check(false, "try transfering more than allowed");
    }
+
+   void token_contract::account::use_nonce(uint64_t nonce, name payer) {
+      nonces _nonces(code(), owner().value);
+
+      auto word = nonce >> 6;
+      auto bit = 1ULL << (nonce & 0x3F);
+
+      auto it = _nonces.find(word);
+      if (it == _nonces.end()) {
+         _nonces.emplace(payer, [&](auto& n) {
+            n.word = word;
+            n.bits = bit;
+         });
+      } else {
+         check(!(it->bits & bit), "nonce already used");
+         _nonces.modify(it, same_payer, [&](auto& n) {
+            n.bits |= bit;
+         });
+      }
+   }
+
+   void token_contract::account::remove_legacy_index(name code, name owner, uint64_t id) {
+      uint64_t secondary;
+      auto itr = internal_use_do_not_use::db_idx64_find_primary(code.value, owner.value, legacy_issuer_index, &secondary, id);
+      if (itr >= 0)
+         internal_use_do_not_use::db_idx64_remove(itr);
+   }
+
+   uint32_t token_contract::account::migrate(name code, name owner, uint32_t max_rows) {
+      uint32_t rows = 0;
+
+      accounts _accounts(code, owner.value);
+      for (auto it = _accounts.begin(); it != _accounts.end() && rows < max_rows; ++it) {
+         if (!it->is_legacy()) continue;
+
+         remove_legacy_index(code, owner, it->id);
+         _accounts.modify(it, same_payer, [&](auto& a) {
+            a.upgrade();
+         });
+         ++rows;
+      }
+
+      // legacy row of allowance is not marked in memory, so it is found by its size
+      allowed _allowed(code, owner.value);
+      for (auto it = _allowed.begin(); it != _allowed.end() && rows < max_rows; ++it) {
+         auto itr = internal_use_do_not_use::db_find_i64(code.value, owner.value, "allowance"_n.value, it->id);
+         if (internal_use_do_not_use::db_get_i64(itr, nullptr, 0) != allowance::legacy_size) continue;
+
+         _allowed.modify(it, same_payer, [&](auto& a) {});
+         ++rows;
+      }
+
+      return rows;
+   }
 }
@@ -13,26 +13,39 @@ namespace gxc {
 
    constexpr name system_account {"gxc"_n};
    constexpr name null_account   {"gxc.null"_n};
+   constexpr name reserve_account {"gxc.reserve"_n};
 
    void token_contract::regtoken(name issuer, symbol_code symbol, name contract) {
       require_auth(_self);
       check(false, "external tokens are not supported yet");
    }
 
-   void token_contract::mint(extended_asset value, std::vector<key_value> opts) {
-      token(_self, value).mint(value, opts);
+   void token_contract::mint(extended_asset value, ignore<std::vector<key_value>> opts) {
+      token(_self, value).mint(value, read_options(_ds));
    }
 
-   void token_contract::setopts(name issuer, symbol_code symbol, std::vector<key_value> opts) {
+   void token_contract::setopts(name issuer, symbol_code symbol, ignore<std::vector<key_value>> opts) {
+      token(_self, issuer, symbol).setopts(read_options(_ds));
+   }
+
+   void token_contract::setopts2(name issuer, symbol_code symbol, std::vector<option> opts) {
       token(_self, issuer, symbol).setopts(opts);
    }
 
-   void token_contract::setacntopts(name account, name issuer, symbol_code symbol, std::vector<key_value> opts) {
+   void token_contract::setacntopts(name account, name issuer, symbol_code symbol, ignore<std::vector<key_value>> opts) {
+      token(_self, issuer, symbol).get_account(account).setopts(read_options(_ds));
+   }
+
+   void token_contract::setacntopts2(name account, name issuer, symbol_code symbol, std::vector<option> opts) {
       token(_self, issuer, symbol).get_account(account).setopts(opts);
    }
 
-   void token_contract::transfer(name from, name to, extended_asset value, std::string memo) {
-      check(memo.size() <= 256, "memo has more than 256 bytes");
+   void token_contract::setacntsopts(name issuer, symbol_code symbol, std::vector<name> accounts, ignore<std::vector<key_value>> opts) {
+      token(_self, issuer, symbol).setacntsopts(accounts, read_options(_ds));
+   }
+
+   void token_contract::transfer(name from, name to, extended_asset value, ignore<std::string> memo) {
+      check(read_view(_ds).size() <= 256, "memo has more than 256 bytes");
       check(from != to, "cannot transfer to self");
       check(is_account(to), "`to` account does not exist");
 
@@ -46,12 +59,56 @@ namespace gxc {
          _token.transfer(from, to, value);
    }
 
-   void token_contract::burn(extended_asset value, std::string memo) {
-      check(memo.size() <= 256, "memo has more than 256 bytes");
+   void token_contract::transfers(name from, name issuer, symbol_code symbol, std::vector<transfer_param> params) {
+      check(params.size(), "no transfers requested");
+
+      for (const auto& p : params) {
+         check(p.memo.size() <= 256, "memo has more than 256 bytes");
+         check(p.to != null_account, "cannot issue or retire in batch transfer");
+      }
+
+      token(_self, issuer, symbol).transfer(from, params);
+   }
+
+   void token_contract::settle(name issuer, symbol_code symbol, std::vector<settlement> params, ignore<std::string> memo) {
+      check(read_view(_ds).size() <= 256, "memo has more than 256 bytes");
+      check(params.size(), "no transfers requested");
+
+      token(_self, issuer, symbol).settle(params);
+   }
+
+   void token_contract::burn(extended_asset value, ignore<std::string> memo) {
+      check(read_view(_ds).size() <= 256, "memo has more than 256 bytes");
 
       token(_self, value).burn(value);
    }
 
+   void token_contract::redeem(name owner, extended_asset value, extended_asset underlying) {
+      require_auth(reserve_account);
+      require_auth(owner);
+      check(underlying.contract == system_account, "underlying asset should be system token");
+
+      token(_self, value).redeem(owner, value);
+      token(_self, underlying).transfer(reserve_account, owner, underlying);
+   }
+
+   void token_contract::redeemmany(name issuer, symbol_code symbol, std::vector<redemption> params) {
+      require_auth(reserve_account);
+      check(params.size(), "no redemptions requested");
+
+      std::vector<transfer_param> payouts;
+      payouts.reserve(params.size());
+
+      for (const auto& p : params) {
+         require_auth(p.owner);
+         check(p.underlying.symbol == params.front().underlying.symbol, "underlying asset should be the same");
+         payouts.push_back({p.owner, p.underlying, ""});
+      }
+
+      token(_self, issuer, symbol).redeem(params);
+      token(_self, system_account, params.front().underlying.symbol).transfer(reserve_account, payouts);
+   }
+
    void token_contract::open(name owner, name issuer, symbol_code symbol, name payer) {
       token(_self, issuer, symbol).get_account(owner).paid_by(payer).open();
    }
@@ -60,6 +117,14 @@ namespace gxc {
       token(_self, issuer, symbol).get_account(owner).close();
    }
 
+   void token_contract::subscribe(name owner, name issuer, symbol_code symbol) {
+      token(_self, issuer, symbol).get_account(owner).subscribe(true);
+   }
+
+   void token_contract::unsubscribe(name owner, name issuer, symbol_code symbol) {
+      token(_self, issuer, symbol).get_account(owner).subscribe(false);
+   }
+
    void token_contract::deposit(name owner, extended_asset value) {
       token(_self, value).deposit(owner, value);
    }
@@ -76,7 +141,76 @@ namespace gxc {
       requests(_self, owner).clear();
    }
 
+   void token_contract::procwithdraws(uint32_t max_rows) {
+      requests::process_queue(_self, max_rows);
+   }
+
+   void token_contract::syncgame(name issuer) {
+      token::sync_game(_self, issuer);
+   }
+
    void token_contract::approve(name owner, name spender, extended_asset value) {
       token(_self, value).get_account(owner).approve(spender, value);
    }
+
+   void token_contract::permit(name owner, name spender, extended_asset value, uint64_t nonce, time_point_sec expiration,
+                               signature sig, ignore<std::string> memo) {
+      check(read_view(_ds).size() <= 256, "memo has more than 256 bytes");
+
+      token(_self, value).permit(owner, spender, value, nonce, expiration, sig);
+   }
+
+   void token_contract::setchainid(checksum256 chain_id) {
+      require_auth(_self);
+      chain_info_singleton(_self, _self.value).set({chain_id}, _self);
+   }
+
+   void token_contract::openstream(name from, name to, extended_asset rate, time_point_sec start, time_point_sec end) {
+      token(_self, rate).open_stream(from, to, rate, start, end);
+   }
+
+   void token_contract::claimstream(uint64_t id) {
+      streams _streams(_self, _self.value);
+      const auto& s = _streams.get(id, "stream not found");
+      token(_self, s.rate).claim_stream(_streams, s);
+   }
+
+   void token_contract::closestream(uint64_t id) {
+      streams _streams(_self, _self.value);
+      const auto& s = _streams.get(id, "stream not found");
+      token(_self, s.rate).close_stream(_streams, s);
+   }
+
+   void token_contract::distribute(name issuer, symbol_code symbol, extended_asset reward) {
+      token(_self, issuer, symbol).distribute(reward);
+   }
+
+   void token_contract::claimreward(name owner, name issuer, symbol_code symbol) {
+      token(_self, issuer, symbol).claim_reward(owner);
+   }
+
+   void token_contract::countholders(name issuer, symbol_code symbol, std::vector<name> owners) {
+      token(_self, issuer, symbol).count_holders(owners);
+   }
+
+   void token_contract::migrate(std::vector<name> owners, uint32_t max_rows) {
+      check(max_rows > 0, "max_rows should be positive");
+
+      for (auto owner : owners) {
+         auto rows = account::migrate(_self, owner, max_rows);
+         max_rows -= rows;
+         if (!max_rows) break;
+
+         rows = requests(_self, owner).enqueue_legacy(_self, max_rows);
+         max_rows -= rows;
+         if (!max_rows) break;
+      }
+   }
 }
+
+GXC_DISPATCH_SAFE(gxc::token_contract, (transfer)(transfers)(settle)(mint)(burn)(redeem)(redeemmany)
+                                        (setopts)(setopts2)(setacntopts)(setacntopts2)(setacntsopts)
+                                        (open)(close)(subscribe)(unsubscribe)(deposit)
+                                        (pushwithdraw)(popwithdraw)(clrwithdraws)(procwithdraws)(syncgame)
+                                        (approve)(permit)(setchainid)(openstream)(claimstream)(closestream)
+                                        (distribute)(claimreward)(countholders)(migrate)(withdraw)(revtwithdraw))
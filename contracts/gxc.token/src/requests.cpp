@@ -3,24 +3,59 @@
  * @copyright defined in gxc/LICENSE
  */
 #include <gxc.token/gxc.token.hpp>
-#include <eosio/transaction.hpp>
+
+#include <limits>
 
 namespace gxc {
 
-   void token_contract::requests::refresh_schedule() {
-      auto _idx = get_index<"schedtime"_n>();
-      auto _it = _idx.begin();
+   void token_contract::requests::schedule() {
+      withdrawq _queue(code(), code().value);
 
-      cancel_deferred(owner().value);
+      auto request_id = _this->primary_key();
+      auto it = _queue.find(withdrawal_queue::get_queue_id(owner(), request_id));
 
-      if (_it != _idx.end()) {
-         transaction out;
-         out.actions.emplace_back(action{{owner(), active_permission}, code(), "clrwithdraws"_n, owner()});
-         out.delay_sec = static_cast<uint32_t>((_it->scheduled_time - current_time_point()).to_seconds());
-         out.send(owner().value, owner(), true);
+      if (it == _queue.end()) {
+         _queue.emplace(owner(), [&](auto& q) {
+            q.owner          = owner();
+            q.request_id     = request_id;
+            q.scheduled_time = _this->scheduled_time;
+         });
+      } else {
+         _queue.modify(it, same_payer, [&](auto& q) {
+            q.scheduled_time = _this->scheduled_time;
+         });
       }
    }
 
+   void token_contract::requests::unschedule() {
+      unschedule(_this->primary_key());
+   }
+
+   void token_contract::requests::unschedule(uint64_t request_id) {
+      withdrawq _queue(code(), code().value);
+
+      // requests made before the queue was introduced have no entry
+      auto it = _queue.find(withdrawal_queue::get_queue_id(owner(), request_id));
+      if (it != _queue.end())
+         _queue.erase(it);
+   }
+
+   void token_contract::requests::pay_out(payouts& batch) {
+      pay_out(*_this, batch);
+   }
+
+   void token_contract::requests::pay_out(const withdrawal_request& rq, payouts& batch) {
+      auto value = rq.value();
+      batch.add(value);
+
+      // requests can be processed by anyone, charge ram to owner only when authorized
+      auto _owner = batch.get_token(value).get_account(owner());
+      name payer = has_auth(owner()) ? owner() : (_owner ? same_payer : code());
+      _owner.paid_by(payer).add_balance(value);
+
+      withdraw_processed(code(), {code(), active_permission}).send(owner(), value);
+   }
+
    void token_contract::requests::clear() {
       require_auth(owner());
 
@@ -29,18 +64,88 @@ namespace gxc {
 
       check(_it != _idx.end(), "withdrawal requests not found");
 
+      auto batch = payouts(code());
+
       for ( ; _it != _idx.end(); _it = _idx.begin()) {
-         auto _token = token(code(), _it->issuer, _it->quantity.symbol);
          if (_it->scheduled_time > current_time_point()) break;
 
-         _token.get_account(code()).sub_balance(_it->value());
-         _token.get_account(owner()).paid_by(owner()).add_balance(_it->value());
+         pay_out(*_it, batch);
+         unschedule(_it->primary_key());
 
-         withdraw_processed(code(), {code(), active_permission}).send(owner(), _it->value());
+         _idx.erase(_it);
+      }
 
+      batch.flush();
+
+      // deferred `clrwithdraws` is not resent anymore, remaining requests are paid out by `procwithdraws`
+      enqueue_legacy(owner(), std::numeric_limits<uint32_t>::max());
+   }
+
+   uint32_t token_contract::requests::enqueue_legacy(name payer, uint32_t max_rows) {
+      withdrawq _queue(code(), code().value);
+      uint32_t rows = 0;
+
+      // requests made before the queue was introduced have no entry
+      auto _idx = get_index<"schedtime"_n>();
+      for (auto _it = _idx.begin(); _it != _idx.end() && rows < max_rows; ++_it) {
+         auto request_id = _it->primary_key();
+         if (_queue.find(withdrawal_queue::get_queue_id(owner(), request_id)) != _queue.end()) continue;
+
+         _queue.emplace(payer, [&](auto& q) {
+            q.owner          = owner();
+            q.request_id     = request_id;
+            q.scheduled_time = _it->scheduled_time;
+         });
+         ++rows;
+      }
+      return rows;
+   }
+
+   void token_contract::requests::process_queue(name code, uint32_t max_rows) {
+      check(max_rows > 0, "max_rows should be positive");
+
+      withdrawq _queue(code, code.value);
+      auto _idx = _queue.get_index<"schedtime"_n>();
+      auto now = current_time_point();
+
+      auto batch = payouts(code);
+
+      for (auto _it = _idx.begin(); _it != _idx.end() && max_rows > 0; _it = _idx.begin(), --max_rows) {
+         if (_it->scheduled_time > now) break;
+
+         // request of owner who cannot receive (e.g. frozen) is left to its `clrwithdraws`, not to block the queue
+         auto _req = requests(code, _it->owner, _it->request_id);
+         if (_req && batch.get_token(_req->value()).get_account(_it->owner).is_payable()) {
+            _req.pay_out(batch);
+            _req.erase();
+         }
          _idx.erase(_it);
       }
 
-      refresh_schedule();
+      batch.flush();
+   }
+
+   token_contract::token& token_contract::payouts::get_token(const extended_asset& value) {
+      auto id = get_token_id(value);
+      auto it = _tokens.find(id);
+      if (it == _tokens.end())
+         it = _tokens.emplace(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple(_code, value)).first;
+      return it->second;
+   }
+
+   void token_contract::payouts::add(const extended_asset& value) {
+      auto id = get_token_id(value);
+      auto it = _debits.find(id);
+      if (it == _debits.end())
+         _debits.emplace(id, value);
+      else
+         it->second.quantity += value.quantity;
+   }
+
+   void token_contract::payouts::flush() {
+      for (const auto& d : _debits) {
+         get_token(d.second).get_account(_code).sub_balance(d.second);
+      }
+      _debits.clear();
    }
 }
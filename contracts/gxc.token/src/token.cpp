@@ -8,7 +8,7 @@
 
 namespace gxc {
 
-   void token_contract::token::mint(extended_asset value, const std::vector<key_value>& opts) {
+   void token_contract::token::mint(extended_asset value, const std::vector<option>& opts) {
       require_auth(code());
       check_asset_is_valid(value);
 
@@ -17,66 +17,171 @@ namespace gxc {
 
       bool init = !exists();
 
+      // options are applied in the same write as supply
       if (init) {
          emplace(code(), [&](auto& t) {
             t.supply.symbol = value.quantity.symbol;
             t.max_supply(value.quantity);
             t.issuer        = value.contract;
+            if (currency_stats::is_game_cacheable(value.contract)) {
+               t.option(opt::game_issuer, has_gauth(value.contract));
+               t.option(opt::game_synced, true);
+            }
+            t.holders.emplace(0);
+            t.total_deposit.emplace(0);
+            _setopts(t, opts, init);
          });
       } else {
          check(_this->option(opt::mintable), "not allowed additional mint");
          modify(same_payer, [&](auto& t) {
             t.max_supply(t.max_supply() + value.quantity);
+            _setopts(t, opts, init);
          });
       }
-
-      _setopts(opts, init);
    }
 
-   void token_contract::token::_setopts(const std::vector<key_value>& opts, bool init) {
-      modify(same_payer, [&](auto& t) {
-         for (auto o : opts) {
-            if (o.first == "paused")
-               t.option(opt::paused, unpack<bool>(o.second));
-            else if (o.first == "whitelist_on")
-               t.option(opt::whitelist_on, unpack<bool>(o.second));
-            else {
-               // Below options can be configured only when creating token.
-               check(init, "not allowed to change the option `" + o.first + "`");
-
-               if (o.first == "mintable") {
-                  t.option(opt::mintable, unpack<bool>(o.second));
-               } else if (o.first == "recallable") {
-                  t.option(opt::recallable, unpack<bool>(o.second));
-               } else if (o.first == "freezable") {
-                  t.option(opt::freezable, unpack<bool>(o.second));
-               } else if (o.first == "pausable") {
-                  t.option(opt::pausable, unpack<bool>(o.second));
-               } else if (o.first == "whitelistable") {
-                  t.option(opt::whitelistable, unpack<bool>(o.second));
-               } else if (o.first == "withdraw_min_amount") {
-                  auto value = unpack<int64_t>(o.second);
-                  check(value >= 0, "withdraw_min_amount should be positive");
-                  t.withdraw_min_amount(asset(value, t.supply.symbol));
-               } else if (o.first == "withdraw_delay_sec") {
-                  auto value = unpack<uint64_t>(o.second);
-                  t.withdraw_delay_sec = static_cast<uint32_t>(value);
-               } else {
-                  check(false, "unknown option `" + o.first + "`");
-               }
+   void token_contract::token::_setopts(currency_stats& t, const std::vector<option>& opts, bool init) {
+      for (const auto& o : opts) {
+         auto key = o.get_key();
+
+         switch (key) {
+         case option_key::paused:
+            t.option(opt::paused, o.value);
+            break;
+         case option_key::whitelist_on:
+            t.option(opt::whitelist_on, o.value);
+            break;
+         default:
+            // Below options can be configured only when creating token.
+            check(init, [&]{ return "not allowed to change the option `" + std::string(option_name(key)) + "`"; });
+
+            switch (key) {
+            case option_key::mintable:
+               t.option(opt::mintable, o.value);
+               break;
+            case option_key::recallable:
+               t.option(opt::recallable, o.value);
+               break;
+            case option_key::freezable:
+               t.option(opt::freezable, o.value);
+               break;
+            case option_key::pausable:
+               t.option(opt::pausable, o.value);
+               break;
+            case option_key::whitelistable:
+               t.option(opt::whitelistable, o.value);
+               break;
+            case option_key::withdraw_min_amount:
+               check(o.value >= 0, "withdraw_min_amount should be positive");
+               t.withdraw_min_amount(asset(o.value, t.supply.symbol));
+               break;
+            case option_key::withdraw_delay_sec:
+               t.withdraw_delay_sec = static_cast<uint32_t>(o.value);
+               break;
+            default:
+               check(false, "unknown option");
             }
          }
-      });
+      }
+
+      check(!t.option(opt::paused) || (init || t.option(opt::pausable)), "not allowed to set paused");
+      check(!t.option(opt::whitelist_on) || t.option(opt::whitelistable), "not allowed to set whitelist");
+   }
+
+   void token_contract::token::sync_game(name code, name issuer) {
+      // registration of virtual issuer is looked up on every issue
+      if (!currency_stats::is_game_cacheable(issuer)) return;
+
+      bool registered = has_gauth(issuer);
+
+      // also backfills tokens minted before the flag was cached
+      stat stats(code, issuer.value);
+      for (auto it = stats.begin(); it != stats.end(); ++it) {
+         if (it->option(opt::game_synced) && it->option(opt::game_issuer) == registered) continue;
+
+         stats.modify(it, same_payer, [&](auto& t) {
+            t.option(opt::game_issuer, registered);
+            t.option(opt::game_synced, true);
+         });
+      }
+   }
+
+   void token_contract::token::update_stats(int64_t holders, int64_t deposit) {
+      if (!is_counting() || (!holders && !deposit)) return;
+
+      _holders_delta += holders;
+      _deposit_delta += deposit;
+
+      if (!_defer_stats) {
+         modify(same_payer, [&](auto& s) {
+            apply_stats(s);
+         });
+      }
+   }
+
+   void token_contract::token::apply_stats(currency_stats& s) {
+      if (!_holders_delta && !_deposit_delta) return;
 
-      check(!_this->option(opt::paused) || (init || _this->option(opt::pausable)), "not allowed to set paused");
-      check(!_this->option(opt::whitelist_on) || _this->option(opt::whitelistable), "not allowed to set whitelist");
+      s.holders.emplace(s.holders.value() + _holders_delta);
+      s.total_deposit.emplace(s.total_deposit.value() + _deposit_delta);
+      _holders_delta = _deposit_delta = 0;
    }
 
-   void token_contract::token::setopts(const std::vector<key_value>& opts) {
+   void token_contract::token::count_holders(const std::vector<name>& owners) {
+      check(exists(), "token not found");
+
+      // start counting token minted before counters were introduced
+      if (!is_counting()) {
+         modify(same_payer, [&](auto& s) {
+            s.holders.emplace(0);
+            s.total_deposit.emplace(0);
+         });
+      }
+
+      int64_t holders = 0;
+      int64_t deposit = 0;
+
+      for (auto owner : owners) {
+         auto _owner = get_account(owner);
+         if (!_owner.exists() || _owner->option(account::opt::counted)) continue;
+
+         _owner.modify(same_payer, [&](auto& a) {
+            a.option(account::opt::counted, true);
+         });
+         ++holders;
+         deposit += _owner->deposit();
+      }
+
+      update_stats(holders, deposit);
+   }
+
+   void token_contract::token::setopts(const std::vector<option>& opts) {
       check(opts.size(), "no changes on options");
       require_vauth(issuer());
 
-      _setopts(opts);
+      modify(same_payer, [&](auto& t) {
+         _setopts(t, opts);
+      });
+   }
+
+   void token_contract::token::setacntsopts(const std::vector<name>& accounts, const std::vector<option>& opts) {
+      check(accounts.size(), "no accounts given");
+      check(opts.size(), "no changes on options");
+      require_vauth(issuer());
+
+      auto payer = basename(issuer());
+
+      for (auto owner : accounts) {
+         auto _owner = get_account(owner);
+
+         if (!_owner) {
+            check(is_account(owner), "account does not exist");
+            _owner.paid_by(payer).open();
+         }
+
+         // accounts already having given options are not treated as error
+         _owner._setopts(opts, false);
+      }
    }
 
    void token_contract::token::issue(name to, extended_asset value) {
@@ -87,19 +192,20 @@ namespace gxc {
       check(value.quantity.symbol == _this->supply.symbol, "symbol precision mismatch");
       check(value.quantity.amount <= _this->max_supply().amount - _this->supply.amount, "quantity exceeds available supply");
 
-      modify(same_payer, [&](auto& s) {
-         s.supply += value.quantity;
-      });
-
-      name payer = (value.contract == "gxc"_n || has_gauth(value.contract)) ? code() : value.contract;
+      bool game = _this->option(opt::game_synced) ? _this->option(opt::game_issuer) : has_gauth(value.contract);
+      name payer = (value.contract == "gxc"_n || game) ? code() : value.contract;
 
-      auto _to = get_account(to);
-
-      if (_this->option(opt::recallable) && (to != value.contract))
-         _to.paid_by(code()).add_deposit(value);
-      else
-         _to.paid_by(payer).add_balance(value);
+      // supply and counters are written at once
+      modify_with_stats([&] {
+         auto _to = get_account(to);
 
+         if (_this->option(opt::recallable) && (to != value.contract))
+            _to.paid_by(code()).add_deposit(value);
+         else
+            _to.paid_by(payer).add_balance(value);
+      }, [&](auto& s) {
+         s.supply += value.quantity;
+      });
    }
 
    void token_contract::token::retire(name owner, extended_asset value) {
@@ -115,16 +221,16 @@ namespace gxc {
          is_recall = true;
       }
 
-      modify(same_payer, [&](auto& s) {
+      modify_with_stats([&] {
+         auto _to = get_account(owner);
+
+         if (!is_recall)
+            _to.sub_balance(value);
+         else
+            _to.paid_by(code()).sub_deposit(value);
+      }, [&](auto& s) {
          s.supply -= value.quantity;
       });
-
-      auto _to = get_account(owner);
-
-      if (!is_recall)
-         _to.sub_balance(value);
-      else
-         _to.paid_by(code()).sub_deposit(value);
    }
 
    void token_contract::token::burn(extended_asset value) {
@@ -136,12 +242,49 @@ namespace gxc {
       //TODO: check game account
       check(value.quantity.symbol == _this->supply.symbol, "symbol precision mismatch");
 
-      modify(same_payer, [&](auto& s) {
+      modify_with_stats([&] {
+         get_account(value.contract).sub_balance(value);
+      }, [&](auto& s) {
+         s.supply -= value.quantity;
+         s.max_supply(s.max_supply() - value.quantity);
+      });
+   }
+
+   void token_contract::token::redeem(name owner, extended_asset value) {
+      check_asset_is_valid(value);
+      check(value.quantity.symbol == _this->supply.symbol, "symbol precision mismatch");
+      check(!_this->option(opt::paused), "token is paused");
+
+      // burn from owner's balance, decrease supply and max supply as `burn` does
+      modify_with_stats([&] {
+         get_account(owner).sub_balance(value);
+      }, [&](auto& s) {
          s.supply -= value.quantity;
          s.max_supply(s.max_supply() - value.quantity);
       });
+   }
 
-      get_account(value.contract).sub_balance(value);
+   void token_contract::token::redeem(const std::vector<redemption>& params) {
+      check(exists(), "token not found");
+      check(!_this->option(opt::paused), "token is paused");
+
+      auto total = asset(0, _this->supply.symbol);
+
+      for (const auto& p : params) {
+         check_asset_is_valid(p.quantity);
+         check(p.quantity.symbol == total.symbol, "symbol precision mismatch");
+         total += p.quantity;
+      }
+
+      // single update of supply and counters for all redemptions
+      modify_with_stats([&] {
+         for (const auto& p : params) {
+            get_account(p.owner).sub_balance(extended_asset(p.quantity, issuer()));
+         }
+      }, [&](auto& s) {
+         s.supply -= total;
+         s.max_supply(s.max_supply() - total);
+      });
    }
 
    void token_contract::token::transfer(name from, name to, extended_asset value) {
@@ -174,30 +317,9 @@ namespace gxc {
       if (!is_recall) {
          _from.sub_balance(value);
       } else {
-         // normal case, transfer from's deposit
-         if (_from->deposit() >= value.quantity) {
-            _from.paid_by(code()).sub_deposit(value);
-         } else {
-            // exceptional case, cached amount is not enough
-            // so withdrawal request is partially cancelled
-            auto leftover = value.quantity - _from->deposit();
-            auto _req = requests(code(), from, value);
-            check(_req, "overdrawn deposit, but no withdrawal request");
-            check(_req->quantity >= leftover, "overdrawn deposit, but not enough withdrawal requested amount");
-
-            if (_req->quantity > leftover) {
-               _req.modify(same_payer, [&](auto& rq) {
-                  rq.quantity -= leftover;
-               });
-            } else {
-               _req.erase();
-               _req.refresh_schedule();
-            }
-            get_account(code()).sub_balance(extended_asset(leftover, value.contract));
-            _from.paid_by(code()).sub_deposit(extended_asset(_from->deposit(), value.contract));
-
-            withdraw_reverted(code(), {code(), active_permission}).send(from, extended_asset(leftover, value.contract));
-         }
+         auto reverted = _from.recall(value);
+         if (reverted.amount > 0)
+            get_account(code()).sub_balance(extended_asset(reverted, value.contract));
       }
 
       name payer;
@@ -213,6 +335,262 @@ namespace gxc {
       get_account(to).paid_by(payer).add_balance(value);
    }
 
+   void token_contract::token::permit(name owner, name spender, extended_asset value, uint64_t nonce, time_point_sec expiration,
+                                      const signature& sig) {
+      require_auth(spender);
+      check(owner != spender, "cannot transfer to self");
+
+      check_asset_is_valid(value);
+      check(!_this->option(opt::paused), "token is paused");
+      check(expiration > current_time_point(), "permit has expired");
+
+      // signed by a key satisfying active permission of owner
+      auto key = recover_key(get_permit_digest(code(), owner, spender, value, nonce, expiration), sig);
+      check(check_permission_authorization(owner, active_permission, {key}), "invalid signature of permit");
+
+      auto _owner = get_account(owner);
+      _owner.use_nonce(nonce, spender);
+      _owner.sub_balance(value);
+
+      // same as approved transfer
+      get_account(spender).paid_by(spender).add_balance(value);
+   }
+
+   void token_contract::token::open_stream(name from, name to, extended_asset rate, time_point_sec start, time_point_sec end) {
+      require_auth(from);
+      check(from != to, "cannot stream to self");
+      check(is_account(to), "`to` account does not exist");
+
+      check_asset_is_valid(rate);
+      check(rate.quantity.symbol == _this->supply.symbol, "symbol precision mismatch");
+      check(!_this->option(opt::paused), "token is paused");
+      check(start < end, "stream should end after start");
+      check(end > current_time_point(), "stream already ended");
+
+      int64_t duration = end.utc_seconds - start.utc_seconds;
+      check(rate.quantity.amount <= asset::max_amount / duration, "total amount of stream overflows");
+      auto total = extended_asset(rate.quantity * duration, rate.contract);
+
+      // escrowed as withdrawal requests are
+      get_account(from).sub_balance(total);
+      get_account(code()).paid_by(code()).add_balance(total);
+
+      streams _streams(code(), code().value);
+      _streams.emplace(from, [&](auto& s) {
+         s.id    = _streams.available_primary_key();
+         s.from  = from;
+         s.to    = to;
+         s.rate  = rate;
+         s.start = start;
+         s.end   = end;
+      });
+   }
+
+   void token_contract::token::claim_stream(streams& table, const stream& s) {
+      require_auth(s.to);
+
+      auto now = time_point_sec(current_time_point());
+      auto value = s.claimable(now);
+      check(value.quantity.amount > 0, "nothing to claim");
+
+      pay_from_escrow(s.to, value, s.to);
+
+      if (now >= s.end) {
+         table.erase(s);
+      } else {
+         table.modify(s, same_payer, [&](auto& r) {
+            r.claimed += value.quantity.amount;
+         });
+      }
+   }
+
+   void token_contract::token::close_stream(streams& table, const stream& s) {
+      require_auth(s.from);
+
+      auto now = time_point_sec(current_time_point());
+      auto value = s.claimable(now);
+      auto refund = extended_asset(asset(s.total() - s.claimed, value.quantity.symbol) - value.quantity, value.contract);
+
+      pay_from_escrow(s.from, refund, s.from);
+
+      // accrued amount is left to be claimed by `to`, so that `to` unable to receive doesn't block refund
+      if (value.quantity.amount > 0) {
+         table.modify(s, same_payer, [&](auto& r) {
+            r.end = std::min(now, r.end);
+         });
+      } else {
+         table.erase(s);
+      }
+   }
+
+   void token_contract::token::pay_from_escrow(name to, extended_asset value, name payer) {
+      if (value.quantity.amount <= 0) return;
+
+      get_account(code()).sub_balance(value);
+
+      // in-game token goes to deposit as `issue` does
+      auto _to = get_account(to);
+      if (_this->option(opt::recallable) && (to != value.contract))
+         _to.paid_by(payer).add_deposit(value);
+      else
+         _to.paid_by(payer).add_balance(value);
+   }
+
+   void token_contract::token::distribute(extended_asset reward) {
+      require_vauth(issuer());
+      check_asset_is_valid(reward);
+      check(!has_reward() || get_reward().symbol == reward.get_extended_symbol(), "reward symbol mismatch");
+
+      bool same = reward.contract == issuer() && reward.quantity.symbol == _this->supply.symbol;
+      token other(code(), reward);
+      auto& _rt = same ? *this : other;
+      check(reward.quantity.symbol == _rt->supply.symbol, "symbol precision mismatch");
+
+      // escrowed by token contract until claimed, as streams are
+      _rt.get_account(issuer()).sub_balance(reward);
+      _rt.get_account(code()).paid_by(code()).add_balance(reward);
+
+      // every account but token contract holding escrow has shares of its balance and deposit
+      auto _escrow = get_account(code());
+      int64_t shares = _this->supply.amount - (_escrow.exists() ? _escrow.balance().amount : 0);
+      check(shares > 0, "no holder to distribute reward");
+
+      // only the accumulator is updated, each account settles its share when its balance changes
+      auto update = [&](auto& p) {
+         int64_t amount = reward.quantity.amount + p.undistributed;
+         uint128_t per_share = (static_cast<uint128_t>(amount) << 64) / static_cast<uint64_t>(shares);
+         p.per_share += per_share;
+         p.undistributed = amount - static_cast<int64_t>((per_share * static_cast<uint64_t>(shares)) >> 64);
+      };
+
+      rewards _rewards(code(), code().value);
+      if (has_reward()) {
+         const auto& it = _rewards.get(token_id());
+         _rewards.modify(it, same_payer, update);
+         _reward = it;
+      } else {
+         auto it = _rewards.emplace(basename(issuer()), [&](auto& p) {
+            p.id     = token_id();
+            p.symbol = reward.get_extended_symbol();
+            update(p);
+         });
+         _reward = *it;
+
+         modify(same_payer, [&](auto& s) {
+            s.option(opt::rewarded, true);
+         });
+      }
+   }
+
+   const token_contract::reward_pool& token_contract::token::get_reward()const {
+      if (!_reward) {
+         rewards _rewards(code(), code().value);
+         _reward = _rewards.get(token_id(), "reward not found");
+      }
+      return *_reward;
+   }
+
+   void token_contract::token::claim_reward(name owner) {
+      require_auth(owner);
+      check(has_reward(), "token has no reward");
+
+      auto _owner = get_account(owner);
+      check(_owner.exists(), "account balance doesn't exist");
+
+      auto amount = _owner.take_reward();
+      check(amount > 0, "no reward to claim");
+
+      const auto& sym = get_reward().symbol;
+      auto value = extended_asset(asset(amount, sym.get_symbol()), sym.get_contract());
+
+      if (value.contract == issuer() && value.quantity.symbol == _this->supply.symbol)
+         pay_from_escrow(owner, value, owner);
+      else
+         token(code(), value).pay_from_escrow(owner, value, owner);
+   }
+
+   void token_contract::token::transfer(name from, const std::vector<transfer_param>& params) {
+      require_auth(from);
+      check(exists(), "token not found");
+      check(!_this->option(opt::paused), "token is paused");
+
+      const auto& sym = _this->supply.symbol;
+
+      // merge amounts by recipient, so that each balance row is written once
+      std::map<name, asset> credits;
+      auto total = asset(0, sym);
+
+      for (const auto& p : params) {
+         check(from != p.to, "cannot transfer to self");
+         check_asset_is_valid(p.quantity);
+         check(p.quantity.symbol == sym, "symbol precision mismatch");
+
+         auto it = credits.find(p.to);
+         if (it == credits.end())
+            credits.emplace(p.to, p.quantity);
+         else
+            it->second += p.quantity;
+
+         total += p.quantity;
+      }
+
+      get_account(from).sub_balance(extended_asset(total, issuer()));
+
+      for (const auto& c : credits) {
+         check(is_account(c.first), "`to` account does not exist");
+         get_account(c.first).paid_by(from).add_balance(extended_asset(c.second, issuer()));
+      }
+   }
+
+   void token_contract::token::settle(const std::vector<settlement>& params) {
+      check(exists(), "token not found");
+      check(_this->option(opt::recallable), "not supported token");
+      require_vauth(issuer());
+      check(!_this->option(opt::paused), "token is paused");
+
+      const auto& sym = _this->supply.symbol;
+
+      // net amount per account, positive for credit and negative for debit
+      std::map<name, asset> deltas;
+
+      auto delta_of = [&](name owner) -> asset& {
+         auto it = deltas.find(owner);
+         if (it == deltas.end())
+            it = deltas.emplace(owner, asset(0, sym)).first;
+         return it->second;
+      };
+
+      for (const auto& p : params) {
+         check(p.from != p.to, "cannot transfer to self");
+         check(p.from != code() && p.to != code(), "cannot settle with token contract");
+         check_asset_is_valid(p.quantity);
+         check(p.quantity.symbol == sym, "symbol precision mismatch");
+
+         delta_of(p.from) -= p.quantity;
+         delta_of(p.to) += p.quantity;
+      }
+
+      auto reverted = asset(0, sym);
+
+      for (const auto& d : deltas) {
+         auto _owner = get_account(d.first);
+
+         if (d.second.amount > 0) {
+            // checked by net amount, account may appear as `from` first
+            check(is_account(d.first), [&]{ return "account `" + d.first.to_string() + "` does not exist"; });
+            _owner.paid_by(code()).add_balance(extended_asset(d.second, issuer()));
+         } else if (d.second.amount < 0) {
+            check(_owner, "overdrawn deposit");
+            reverted += _owner.recall(extended_asset(-d.second, issuer()));
+         } else if (_owner) {
+            _owner.check_account_is_valid();
+         }
+      }
+
+      if (reverted.amount > 0)
+         get_account(code()).sub_balance(extended_asset(reverted, issuer()));
+   }
+
    void token_contract::token::deposit(name owner, extended_asset value) {
       check_asset_is_valid(value);
       check(_this->option(opt::recallable), "not supported token");
@@ -248,7 +626,7 @@ namespace gxc {
       get_account(owner).keep().sub_deposit(value);
       get_account(code()).paid_by(code()).add_balance(value);
 
-      _req.refresh_schedule();
+      _req.schedule();
    }
 
    void token_contract::token::cancel_withdraw(name owner, name issuer, symbol_code sym) {
@@ -263,6 +641,7 @@ namespace gxc {
 
       withdraw_reverted(code(), {code(), active_permission}).send(owner, value);
 
+      _req.unschedule();
       _req.erase();
    }
 }
@@ -7,6 +7,7 @@
 #include <eosio/eosio.hpp>
 #include <eosio/system.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio-xt/crypto.hpp>
 #include <utf8/utf8.h>
 #include <gxclib/system.hpp>
 
@@ -28,14 +29,32 @@ public:
    [[eosio::action]]
    void setnick(name account_name, string nickname);
 
+   struct nickname_param {
+      name   account_name;
+      string nickname;
+
+      EOSLIB_SERIALIZE(nickname_param, (account_name)(nickname))
+   };
+
+   [[eosio::action]]
+   void setnicks(name payer, const std::vector<nickname_param>& params);
+
    [[eosio::action]]
    void rmvnick(name account_name);
 
    [[eosio::action]]
    void payram4nick(name account_name);
 
+   [[eosio::action]]
+   void migratenick(name account_name);
+
    void authenticate(name account_name, name game_name, const string& login_token);
 
+   static uint64_t nickname_hash(const string& nickname) {
+      return xxh3_64(nickname.data(), nickname.size());
+   }
+
+   // legacy table indexed by sha256, moved to `nick2` by migratenick or payram4nick of each account
    struct [[eosio::table, eosio::contract("gxc.user")]] nickrow {
       name    account_name;
       string  nickname;
@@ -51,6 +70,25 @@ public:
       indexed_by<"nickname"_n, const_mem_fun<nickrow, eosio::checksum256, &nickrow::secondary_key>>
    > nicktable;
 
+   struct [[eosio::table("nick2"), eosio::contract("gxc.user")]] nickrow2 {
+      name    account_name;
+      string  nickname;
+      string  title;
+
+      uint64_t primary_key()const { return account_name.value; }
+      uint64_t by_nickname()const { return nickname_hash(nickname); }
+
+      EOSLIB_SERIALIZE(nickrow2, (account_name)(nickname)(title))
+   };
+
+   /**
+    * Nicknames indexed by 64-bit hash.
+    * Rows having the same hash are adjacent in the index, so that lookup compares stored nickname.
+    */
+   typedef eosio::multi_index<"nick2"_n, nickrow2,
+      indexed_by<"nickname"_n, const_mem_fun<nickrow2, uint64_t, &nickrow2::by_nickname>>
+   > nicktable2;
+
    static bool is_valid_nickname(string nickname) {
       if (nickname.empty()) return false;
 
@@ -62,6 +100,15 @@ public:
    }
 
 private:
+   bool migrate_legacy_nick(name account_name);
+   bool has_nickname(name account_name)const;
+   bool is_nickname_occupied(const string& nickname)const;
+
+   static void check_nickname(const string& nickname) {
+      check(nickname.size() >= 6 && nickname.size() <= 24, "nickname has invalid length");
+      check(is_valid_nickname(nickname), "nickname contains invalid character");
+   }
+
    constexpr static bool is_valid_char(uint32_t cp) {
       if( (cp >= 'A') && (cp <= 'Z') ) return true;
       if( (cp >= 'a') && (cp <= 'z') ) return true;
@@ -3,6 +3,9 @@
  * @copyright defined in gxc/LICENSE
  */
 #include <gxc.user/gxc.user.hpp>
+#include <gxclib/dispatcher.hpp>
+
+#include <set>
 
 namespace gxc {
 
@@ -23,30 +26,41 @@ void user_contract::connect(name account_name, name game_name, string login_toke
 }
 
 void user_contract::setnick(name account_name, string nickname) {
-   check(nickname.size() >= 6 && nickname.size() <= 24, "nickname has invalid length");
-   check(is_valid_nickname(nickname), "nickname contains invalid character");
+   check_nickname(nickname);
 
    check(has_auth(system_account) || has_auth(account_name), "missing required authority");
 
-   nicktable nt(_self, _self.value);
+   check(!is_nickname_occupied(nickname), "nickname already occupied");
+   check(!has_nickname(account_name), "nickname change not supported");
 
-   const auto& idx = nt.get_index<"nickname"_n>();
-   auto dup = idx.find(sha256(nickname.data(), nickname.size()));
-   check(dup == idx.end(), "nickname already occupied");
+   auto payer = has_auth(account_name) ? account_name : _self;
 
-   auto cb = [&](auto& n) {
+   nicktable2 nt(_self, _self.value);
+   nt.emplace(payer, [&](auto& n) {
       n.account_name = account_name;
       n.nickname = nickname;
-   };
+   });
+}
 
-   auto payer = has_auth(account_name) ? account_name : _self;
+void user_contract::setnicks(name payer, const std::vector<nickname_param>& params) {
+   require_auth(system_account);
+   require_auth(payer);
+   check(params.size(), "no nicknames given");
 
-   auto itr = nt.find(account_name.value);
-   if (itr != nt.end()) {
-      check(false, "nickname change not supported");
-      //nt.modify(itr, same_payer, cb);
-   } else {
-      nt.emplace(payer, cb);
+   nicktable2 nt(_self, _self.value);
+
+   std::set<std::string_view> nicknames;
+
+   for (const auto& p : params) {
+      check_nickname(p.nickname);
+
+      check(nicknames.insert(p.nickname).second && !is_nickname_occupied(p.nickname), "nickname already occupied");
+      check(!has_nickname(p.account_name), "nickname change not supported");
+
+      nt.emplace(payer, [&](auto& n) {
+         n.account_name = p.account_name;
+         n.nickname = p.nickname;
+      });
    }
 }
 
@@ -56,7 +70,7 @@ void user_contract::rmvnick(name account_name) {
    // control flow should not reach here
    require_auth(_self);
 
-   nicktable nt(_self, _self.value);
+   nicktable2 nt(_self, _self.value);
 
    auto itr = nt.find(account_name.value);
    check(itr != nt.end(), "nickname not registered");
@@ -67,12 +81,65 @@ void user_contract::rmvnick(name account_name) {
 void user_contract::payram4nick(name account_name) {
    require_auth(account_name);
 
-   nicktable nt(_self, _self.value);
+   nicktable2 nt(_self, _self.value);
 
    auto itr = nt.find(account_name.value);
-   check(itr != nt.end(), "nickname is not set with given account");
+   if (itr != nt.end()) {
+      nt.modify(itr, account_name, [&](auto& n) {});
+      return;
+   }
 
-   nt.modify(itr, account_name, [&](auto& n) {});
+   check(migrate_legacy_nick(account_name), "nickname is not set with given account");
 }
 
+void user_contract::migratenick(name account_name) {
+   require_auth(account_name);
+   check(migrate_legacy_nick(account_name), "nickname is not set in legacy table");
 }
+
+bool user_contract::migrate_legacy_nick(name account_name) {
+   nicktable legacy(_self, _self.value);
+
+   auto it = legacy.find(account_name.value);
+   if (it == legacy.end()) return false;
+
+   // paid by the account itself, not to move ram of users to gxc.user
+   nicktable2 nt(_self, _self.value);
+   nt.emplace(account_name, [&](auto& n) {
+      n.account_name = it->account_name;
+      n.nickname = it->nickname;
+      n.title = it->title;
+   });
+   legacy.erase(it);
+   return true;
+}
+
+bool user_contract::has_nickname(name account_name)const {
+   nicktable2 nt(_self, _self.value);
+   if (nt.find(account_name.value) != nt.end()) return true;
+
+   nicktable legacy(_self, _self.value);
+   return legacy.find(account_name.value) != legacy.end();
+}
+
+bool user_contract::is_nickname_occupied(const string& nickname)const {
+   nicktable2 nt(_self, _self.value);
+   const auto& idx = nt.get_index<"nickname"_n>();
+
+   auto hash = nickname_hash(nickname);
+   for (auto it = idx.lower_bound(hash); it != idx.end() && it->by_nickname() == hash; ++it) {
+      if (it->nickname == nickname) return true;
+   }
+
+   // sha256 is computed only until legacy table is migrated
+   nicktable legacy(_self, _self.value);
+   if (legacy.begin() == legacy.end()) return false;
+
+   const auto& legacy_idx = legacy.get_index<"nickname"_n>();
+   return legacy_idx.find(sha256(nickname.data(), nickname.size())) != legacy_idx.end();
+}
+
+}
+
+GXC_DISPATCH_SAFE(gxc::user_contract, (connect)(login)(setnick)(setnicks)(rmvnick)(payram4nick)
+                                       (migratenick))
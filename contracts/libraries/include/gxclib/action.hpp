@@ -4,25 +4,30 @@
  */
 #pragma once
 #include <eosio/action.hpp>
+#include <gxclib/name.hpp>
 
 namespace eosio {
 
-name rootname(name n) {
-   auto mask = (uint64_t) -1;
-   for (auto i = 0; i < 12; ++i) {
-      if (n.value & (0x1FULL << (4 + 5 * (11 - i))))
-         continue;
-      mask <<= 4 + 5 * (11 - i);
-      break;
-   }
-   return name(n.value & mask);
+/**
+ * Returns the name truncated at the first dot.
+ */
+constexpr name rootname(name n) {
+   auto dots = ~gxc::name_bits::nonzero_flags(n.value) & gxc::name_bits::group_lsb;
+   if (!dots) return n;
+   return name(n.value & (~0ull << gxc::name_bits::msb(dots)));
 }
 
-name basename(name n) {
-   if (is_account(n))
+static_assert(rootname(name("gxc.token")) == name("gxc"));
+static_assert(rootname(name("gxctoken")) == name("gxctoken"));
+static_assert(rootname(name("a.b.c")) == name("a"));
+
+inline name basename(name n) {
+   auto root = rootname(n);
+   // name without dot is its own root, no need to ask the chain
+   if (root == n || is_account(n))
       return n;
    else
-      return rootname(n);
+      return root;
 }
 
 inline bool has_vauth(name n) {
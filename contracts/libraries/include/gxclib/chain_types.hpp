@@ -8,6 +8,7 @@
 #include <eosio/producer_schedule.hpp>
 
 #include "types.hpp"
+#include "dispatcher.hpp"
 
 namespace eosio { namespace chain {
 
@@ -65,3 +66,40 @@ struct newaccount {
 };
 
 } }
+
+namespace gxc {
+
+   /**
+    * Skips packed `authority` in action data and returns its raw bytes,
+    * without deserializing keys, accounts and waits.
+    */
+   template<typename Stream>
+   inline std::string_view read_authority_view(Stream& ds) {
+      auto data = ds.pos();
+
+      // sizes are computed in 64 bits, not to wrap around on wasm32
+      auto skip = [&](uint64_t n) {
+         eosio::check(n <= ds.remaining(), "read");
+         ds.skip(static_cast<size_t>(n));
+      };
+
+      skip(sizeof(uint32_t)); // threshold
+
+      for (auto n = read_size(ds); n > 0; --n) {
+         auto type = read_size(ds); // index of public_key variant
+         eosio::check(type <= 2, "invalid type of public key");
+
+         skip(33); // K1, R1 or key of WebAuthn
+         if (type == 2) {
+            skip(1); // user presence
+            skip(read_size(ds)); // rpid
+         }
+         skip(sizeof(uint16_t)); // weight
+      }
+
+      skip(static_cast<uint64_t>(read_size(ds)) * (sizeof(eosio::permission_level) + sizeof(uint16_t))); // accounts
+      skip(static_cast<uint64_t>(read_size(ds)) * (sizeof(uint32_t) + sizeof(uint16_t))); // waits
+
+      return std::string_view(data, ds.pos() - data);
+   }
+}
@@ -0,0 +1,31 @@
+/**
+ * @file
+ * @copyright defined in gxc/LICENSE
+ */
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <string>
+#include <type_traits>
+
+namespace gxc {
+
+   using eosio::check;
+
+   /**
+    * Assert if the predicate fails and use the message built by @ref make_msg.
+    * Unlike eosio::check with concatenated std::string, message is built only on failure.
+    *
+    * @brief Assert if the predicate fails, building error message lazily
+    * @param pred - predicate to be checked
+    * @param make_msg - callable returning error message
+    */
+   template<typename F, typename = std::enable_if_t<std::is_invocable_v<F>>>
+   inline void check(bool pred, F&& make_msg) {
+      if (!pred) {
+         const std::string msg = make_msg();
+         eosio::check(false, msg);
+      }
+   }
+}
@@ -2,40 +2,126 @@
  * @file
  * @copyright defined in gxc/LICENSE
  */
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/varint.hpp>
+
+#include <string_view>
+
+#include <boost/preprocessor/punctuation/comma_if.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+namespace gxc {
+
+   /**
+    * Perfect hash of action names, found at compile time.
+    * Index is `(action * multiplier) >> (64 - bits)` and distinct for every given name,
+    * so dispatcher can jump to the handler with one multiplication and one comparison.
+    */
+   template<uint64_t... Names>
+   struct action_hash {
+      static constexpr uint64_t names[] = { Names... };
+
+      static constexpr uint32_t bits = [] {
+         // table is sized at least 4 times the number of actions to find multiplier quickly
+         uint32_t b = 1;
+         while ((1u << b) < 4 * sizeof...(Names)) ++b;
+         return b;
+      }();
+
+      static constexpr bool is_perfect(uint64_t m) {
+         bool used[1u << bits] = {};
+         for (auto n : names) {
+            auto i = (n * m) >> (64 - bits);
+            if (used[i]) return false;
+            used[i] = true;
+         }
+         return true;
+      }
+
+      static constexpr uint64_t find_multiplier() {
+         uint64_t m = 0x9e3779b97f4a7c15ull;
+         while (!is_perfect(m)) m += 2;
+         return m;
+      }
+
+      static constexpr uint64_t multiplier = find_multiplier();
+
+      static constexpr uint32_t of(uint64_t action) {
+         return static_cast<uint32_t>((action * multiplier) >> (64 - bits));
+      }
+   };
+
+   /**
+    * Reads the size prefix of `string`, `bytes` or vector from action data.
+    * Used with `ignore<T>` parameter and `_ds` of contract, as native action handlers do.
+    */
+   template<typename Stream>
+   inline uint32_t read_size(Stream& ds) {
+      eosio::unsigned_int size;
+      ds >> size;
+      return size.value;
+   }
+
+   /**
+    * Reads `string` or `bytes` from action data as non-owning view without copying.
+    * The view is valid while action data is alive, that is, during the action.
+    */
+   template<typename Stream>
+   inline std::string_view read_view(Stream& ds) {
+      auto size = read_size(ds);
+      eosio::check(size <= ds.remaining(), "read");
+      auto data = ds.pos();
+      ds.skip(size);
+      return std::string_view(data, size);
+   }
+}
+
+#define GXC_DISPATCH_NAME( r, _, i, elem ) \
+   BOOST_PP_COMMA_IF(i) eosio::name( BOOST_PP_STRINGIZE(elem) ).value
 
 #define GXC_DISPATCH_INTERNAL( r, OP, elem ) \
-   case eosio::name( BOOST_PP_STRINGIZE(elem) ).value: \
-      eosio::execute_action( eosio::name(receiver), eosio::name(code), &OP::elem ); \
+   case action_index::of( eosio::name( BOOST_PP_STRINGIZE(elem) ).value ): \
+      if( action == eosio::name( BOOST_PP_STRINGIZE(elem) ).value ) { \
+         eosio::execute_action( eosio::name(receiver), eosio::name(code), &OP::elem ); \
+         return true; \
+      } \
       break;
 
 #define GXC_DISPATCH_HELPER( TYPE,  MEMBERS ) \
    BOOST_PP_SEQ_FOR_EACH( GXC_DISPATCH_INTERNAL, TYPE, MEMBERS )
 
+/* dispatches through a jump table indexed by perfect hash of action names, returns false if not found */
+#define GXC_DISPATCH_TABLE( TYPE, MEMBERS ) \
+   [&]() -> bool { \
+      using action_index = ::gxc::action_hash< BOOST_PP_SEQ_FOR_EACH_I( GXC_DISPATCH_NAME, _, MEMBERS ) >; \
+      switch( action_index::of(action) ) { \
+         GXC_DISPATCH_HELPER( TYPE, MEMBERS ) \
+      } \
+      return false; \
+   }()
+
 #define GXC_DISPATCH( TYPE, MEMBERS ) \
 extern "C" { \
    void apply( uint64_t receiver, uint64_t code, uint64_t action ) { \
-      if( code == receiver ) { \
-         switch( action ) { \
-            GXC_DISPATCH_HELPER( TYPE, MEMBERS ) \
-         } \
-         /* does not allow destructor of thiscontract to run: eosio_exit(0); */ \
-      } \
+      if( code != receiver ) return; \
+      GXC_DISPATCH_TABLE( TYPE, MEMBERS ); \
+      /* does not allow destructor of thiscontract to run: eosio_exit(0); */ \
    } \
 } \
 
 #define GXC_DISPATCH_SAFE( TYPE, MEMBERS ) \
 extern "C" { \
    void apply( uint64_t receiver, uint64_t code, uint64_t action ) { \
-      if( code == receiver ) { \
-         switch( action ) { \
-            GXC_DISPATCH_HELPER( TYPE, MEMBERS ) \
-            default: \
-               auto msg = "action '" + ::eosio::name(action).to_string() + "' not found"; \
-               eosio_assert(false, msg.data()); \
-               break; \
-         } \
-         /* does not allow destructor of thiscontract to run: eosio_exit(0); */ \
+      if( code != receiver ) return; \
+      if( !GXC_DISPATCH_TABLE( TYPE, MEMBERS ) ) { \
+         auto msg = "action '" + ::eosio::name(action).to_string() + "' not found"; \
+         eosio::check(false, msg); \
       } \
+      /* does not allow destructor of thiscontract to run: eosio_exit(0); */ \
    } \
 } \
-
@@ -10,12 +10,65 @@ namespace gxc {
    using eosio::asset;
    using eosio::symbol;
 
-   typedef double real_type;
+   /**
+    * floor(a * b / d) with 256-bit intermediate product, result should fit in 128 bits
+    */
+   constexpr uint128_t mul_div(uint128_t a, uint128_t b, uint128_t d) {
+      constexpr uint128_t mask = static_cast<uint64_t>(-1);
+
+      uint128_t ll = (a & mask) * (b & mask);
+      uint128_t lh = (a & mask) * (b >> 64);
+      uint128_t hl = (a >> 64) * (b & mask);
+      uint128_t hh = (a >> 64) * (b >> 64);
+
+      uint128_t mid = (ll >> 64) + (lh & mask) + (hl & mask);
+      uint128_t lo  = (mid << 64) | (ll & mask);
+      uint128_t hi  = hh + (lh >> 64) + (hl >> 64) + (mid >> 64);
+
+      if (hi == 0) return lo / d;
+
+      // long division of hi:lo by d
+      uint128_t q = 0, r = 0;
+      for (int i = 255; i >= 0; --i) {
+         bool carry = r >> 127;
+         r = (r << 1) | ((i >= 128 ? (hi >> (i - 128)) : (lo >> i)) & 1);
+         q <<= 1;
+         if (carry || r >= d) {
+            r -= d;
+            q |= 1;
+         }
+      }
+      return q;
+   }
+
+   /**
+    * floor(sqrt(n))
+    */
+   constexpr uint64_t isqrt(uint128_t n) {
+      uint128_t res = 0;
+      uint128_t bit = static_cast<uint128_t>(1) << 126;
+
+      while (bit > n) bit >>= 2;
+
+      while (bit) {
+         if (n >= res + bit) {
+            n -= res + bit;
+            res = (res >> 1) + bit;
+         } else {
+            res >>= 1;
+         }
+         bit >>= 2;
+      }
+      return static_cast<uint64_t>(res);
+   }
 
    /**
     *  Uses Bancor math to create a 50/50 relay between two asset types. The state of the
     *  bancor exchange is entirely contained within this struct. There are no external
     *  side effects associated with using this API.
+    *
+    *  Conversion is computed in integer arithmetic with connector weight fixed to 0.5,
+    *  so that results are deterministic and reproducible off-chain with the same functions.
     */
    struct [[eosio::table, eosio::contract("gxc.system")]] exchange_state {
       asset    supply;
@@ -32,10 +85,58 @@ namespace gxc {
 
       uint64_t primary_key()const { return supply.symbol.raw(); }
 
+      /**
+       * Supply issued by depositing `in` to connector of `balance`,
+       * `supply * (sqrt(1 + in / (balance + in)) - 1)` rounded down.
+       *
+       * Evaluated as `supply * in / (sqrt(c * (c + in)) + c)` with `c = balance + in`.
+       * Both terms are scaled by `2^k` to keep precision of the square root, which is
+       * rounded up so that issued supply never exceeds exact value.
+       */
+      static constexpr int64_t get_exchange_out(int64_t supply, int64_t balance, int64_t in) {
+         uint128_t c = static_cast<uint128_t>(balance) + in;
+         uint128_t n = c * (c + in);
+
+         int k = 0;
+         while (k < 63 && (n >> (125 - 2 * k)) == 0) ++k;
+         n <<= 2 * k;
+
+         uint128_t s = isqrt(n);
+         if (s * s < n) ++s;
+         return static_cast<int64_t>(mul_div(supply, static_cast<uint128_t>(in) << k, s + (c << k)));
+      }
+
+      /**
+       * Connector balance released by returning `in` of `supply`,
+       * `balance * ((1 + in / (supply - in))^2 - 1)` rounded down.
+       */
+      static constexpr int64_t get_connector_out(int64_t supply, int64_t balance, int64_t in) {
+         uint128_t r = static_cast<uint128_t>(supply - in);
+         uint128_t x = static_cast<uint128_t>(in) * (2 * r + in);
+         return static_cast<int64_t>(mul_div(balance, x, r) / r);
+      }
+
+      const connector& get_connector(const symbol& sym, const char* msg)const {
+         if (sym == base.balance.symbol) return base;
+         eosio::check(sym == quote.balance.symbol, msg);
+         return quote;
+      }
+
+      connector& get_connector(const symbol& sym, const char* msg) {
+         if (sym == base.balance.symbol) return base;
+         eosio::check(sym == quote.balance.symbol, msg);
+         return quote;
+      }
+
       asset convert_to_exchange(connector& c, asset in);
       asset convert_from_exchange(connector& c, asset in);
       asset convert(asset from, const symbol& to);
 
+      /**
+       * Returns the result of @ref convert without modifying the state.
+       */
+      asset get_quote(asset from, const symbol& to)const;
+
       EOSLIB_SERIALIZE(exchange_state, (supply)(base)(quote))
    };
 
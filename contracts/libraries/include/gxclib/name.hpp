@@ -11,36 +11,96 @@ namespace gxc {
 
 using eosio::name;
 
-bool starts_with(const name& input, const name& test) {
-   uint64_t mask = 0xF800000000000000ull;
-   auto maxlen = 12;
-   auto v = input.value;
-   auto c = test.value;
+   /**
+    * Bit-parallel helpers operating on 5-bit character groups of name.
+    * The first 12 characters occupy bits [4, 64) from the most significant side,
+    * and the 13th character occupies the lowest 4 bits.
+    */
+   namespace name_bits {
+      // lowest bit of each of 12 character groups
+      constexpr uint64_t group_lsb = 0x0842108421084210ull;
+      constexpr uint64_t group_all = ~0xFull;
 
-   for (auto i = 0; i < maxlen; ++i, v <<= 5, c<<= 5) {
-      if ((v & mask) == (c & mask)) continue;
+      /**
+       * Lowest bit of each character group set if the character is not a dot,
+       * and bit 0 set if the 13th character exists.
+       */
+      constexpr uint64_t nonzero_flags(uint64_t v) {
+         uint64_t nz = (v | (v >> 1) | (v >> 2) | (v >> 3) | (v >> 4)) & group_lsb;
+         return nz | ((v & 0xF) ? 1 : 0);
+      }
 
-      if (c & mask) return false;
-      else break;
+      /**
+       * Lowest bit of the character group containing bit `p`.
+       */
+      constexpr int group_of(int p) {
+         return p < 4 ? 0 : (p - 4) / 5 * 5 + 4;
+      }
+
+      constexpr int msb(uint64_t v) { return 63 - __builtin_clzll(v); }
+      constexpr int lsb(uint64_t v) { return __builtin_ctzll(v); }
+
+      constexpr uint8_t char_to_value(char c) {
+         if (c == '.') return 0;
+         if (c >= '1' && c <= '5') return (c - '1') + 1;
+         if (c >= 'a' && c <= 'z') return (c - 'a') + 6;
+         return 0xFF;
+      }
    }
 
-   return true;
-}
+   /**
+    * Returns the number of characters of name, same as eosio::name::length().
+    */
+   constexpr uint8_t name_length(name input) {
+      if (!input.value) return 0;
 
-bool starts_with(const name& input, const boost::string_view& test) {
-   return boost::string_view(input.to_string()).starts_with(test);
-}
+      auto p = name_bits::group_of(name_bits::lsb(input.value));
+      return p ? 12 - (p - 4) / 5 : 13;
+   }
 
-bool has_dot(eosio::name input) {
-   uint64_t mask = 0xF800000000000000ull;
-   auto v = input.value;
-   auto len = input.length();
-   auto has_dot = false;
+   /**
+    * Returns true if `test` is a prefix of `input`, compared up to the first different character.
+    */
+   constexpr bool starts_with(const name& input, const name& test) {
+      uint64_t diff = (input.value ^ test.value) & name_bits::group_all;
+      if (!diff) return true;
 
-   for (auto i = 0; i < len; ++i, v <<= 5) {
-      has_dot |= !(v & mask);
+      auto p = name_bits::group_of(name_bits::msb(diff));
+      return !((test.value >> p) & 0x1F);
    }
-   return has_dot;
-}
+
+   bool starts_with(const name& input, const boost::string_view& test) {
+      auto len = test.size();
+      if (len > 13 || len > name_length(input)) return false;
+
+      uint64_t value = 0, mask = 0;
+      for (size_t i = 0; i < len; ++i) {
+         auto c = name_bits::char_to_value(test[i]);
+         if (c == 0xFF || (i == 12 && c > 0x0F)) return false;
+
+         auto shift = (i < 12) ? 64 - 5 * (i + 1) : 0;
+         value |= uint64_t(c) << shift;
+         mask  |= uint64_t(i < 12 ? 0x1F : 0x0F) << shift;
+      }
+      return (input.value & mask) == value;
+   }
+
+   /**
+    * Returns true if name contains a dot before its last character.
+    */
+   constexpr bool has_dot(eosio::name input) {
+      auto nz = name_bits::nonzero_flags(input.value);
+      auto low = nz & (~nz + 1);
+      auto dots = ~nz & ((name_bits::group_lsb) | 1);
+      return low && dots > low;
+   }
+
+   static_assert(name_length(name("gxc.token")) == 9);
+   static_assert(name_length(name("abcdefghijklj")) == 13);
+   static_assert(starts_with(name("gxc.token"), name("gxc")));
+   static_assert(!starts_with(name("gxc.token"), name("gxd")));
+   static_assert(has_dot(name("gxc.token")));
+   static_assert(!has_dot(name("gxctoken")));
+   static_assert(!has_dot(name()));
 
 }
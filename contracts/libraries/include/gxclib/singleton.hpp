@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @copyright defined in gxc/LICENSE
+ */
+#pragma once
+
+#include <eosio/singleton.hpp>
+
+namespace gxc {
+
+using eosio::name;
+
+   /**
+    * Wraps eosio::singleton with lazy loading and dirty tracking.
+    * The row is read on first access and written back by @ref flush only when it was
+    * obtained for modification (or did not exist yet), so actions which never touch
+    * the state pay neither deserialization nor db update.
+    *
+    * @brief Singleton loaded on demand and written back only when modified
+    */
+   template<name::raw SingletonName, typename T>
+   class cached_singleton {
+   public:
+      using default_state_func = T (*)(name code);
+
+      cached_singleton(name code, uint64_t scope, default_state_func default_state)
+      : _singleton(code, scope)
+      , _code(code)
+      , _default_state(default_state)
+      {}
+
+      const T& get() {
+         load();
+         return _state;
+      }
+
+      T& modify() {
+         load();
+         _dirty = true;
+         return _state;
+      }
+
+      bool is_dirty()const { return _dirty; }
+
+      void flush(name payer) {
+         if (_dirty) {
+            _singleton.set(_state, payer);
+            _dirty = false;
+         }
+      }
+
+   private:
+      void load() {
+         if (_loaded) return;
+
+         if (_singleton.exists()) {
+            _state = _singleton.get();
+         } else {
+            // persist initial state at the end of action, as eager singleton usage did
+            _state = _default_state(_code);
+            _dirty = true;
+         }
+         _loaded = true;
+      }
+
+      eosio::singleton<SingletonName, T> _singleton;
+      name               _code;
+      default_state_func _default_state;
+      T                  _state;
+      bool               _loaded = false;
+      bool               _dirty = false;
+   };
+}
@@ -33,13 +33,20 @@ asset get_supply(name issuer, symbol_code sym_code) {
 asset get_balance(name owner, name issuer, symbol_code sym_code) {
    asset balance;
    auto esc = extended_symbol_code(sym_code, issuer);
-   db_get_i64(db_find_i64(token_account.value, issuer.value, "accounts"_n.value,
-                          xxh3_64(reinterpret_cast<const char*>(&esc), sizeof(uint128_t))),
-              reinterpret_cast<void*>(&balance), sizeof(asset));
+   auto itr = db_find_i64(token_account.value, owner.value, "accounts"_n.value,
+                          xxh3_64(reinterpret_cast<const char*>(&esc), sizeof(uint128_t)));
+   db_get_i64(itr, reinterpret_cast<void*>(&balance), sizeof(asset));
+
+   // legacy row (32 bytes) starts with asset, but v2 row starts with amount followed by token id
+   if (db_get_i64(itr, nullptr, 0) != 32)
+      balance.symbol = get_supply(issuer, sym_code).symbol;
    return balance;
 }
 
 struct token_contract_mock {
+   // no authority, for permissionless actions (e.g. `syncgame`)
+   token_contract_mock() = default;
+
    token_contract_mock(name auth) {
       auths.emplace_back(permission_level(auth, active_permission));
    }
@@ -51,6 +58,14 @@ struct token_contract_mock {
 
    using key_value = std::pair<std::string, std::vector<int8_t>>;
 
+   struct redemption {
+      name  owner;
+      asset quantity;
+      asset underlying;
+
+      EOSLIB_SERIALIZE(redemption, (owner)(quantity)(underlying))
+   };
+
    void mint(extended_asset value, std::vector<key_value> opts) {
       action_wrapper<"mint"_n, &token_contract_mock::mint>(std::move(name(token_account)), auths)
       .send(value, opts);
@@ -66,6 +81,21 @@ struct token_contract_mock {
       .send(value, memo);
    }
 
+   void redeem(name owner, extended_asset value, extended_asset underlying) {
+      action_wrapper<"redeem"_n, &token_contract_mock::redeem>(std::move(name(token_account)), auths)
+      .send(owner, value, underlying);
+   }
+
+   void redeemmany(name issuer, symbol_code symbol, std::vector<redemption> params) {
+      action_wrapper<"redeemmany"_n, &token_contract_mock::redeemmany>(std::move(name(token_account)), auths)
+      .send(issuer, symbol, params);
+   }
+
+   void syncgame(name issuer) {
+      action_wrapper<"syncgame"_n, &token_contract_mock::syncgame>(std::move(name(token_account)), auths)
+      .send(issuer);
+   }
+
    std::vector<permission_level> auths;
 };
 
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * @copyright defined in gxc/LICENSE
+ */
+#include <eosio/tester.hpp>
+#include <gxclib/action.hpp>
+#include <gxclib/name.hpp>
+
+#include <cstring>
+#include <string>
+
+using eosio::name;
+
+// Previous implementations, kept as reference of bit-parallel ones
+namespace reference {
+
+   bool starts_with(const name& input, const name& test) {
+      uint64_t mask = 0xF800000000000000ull;
+      auto maxlen = 12;
+      auto v = input.value;
+      auto c = test.value;
+
+      for (auto i = 0; i < maxlen; ++i, v <<= 5, c<<= 5) {
+         if ((v & mask) == (c & mask)) continue;
+
+         if (c & mask) return false;
+         else break;
+      }
+
+      return true;
+   }
+
+   bool starts_with(const name& input, const boost::string_view& test) {
+      return boost::string_view(input.to_string()).starts_with(test);
+   }
+
+   bool has_dot(name input) {
+      uint64_t mask = 0xF800000000000000ull;
+      auto v = input.value;
+      auto len = input.length();
+      auto has_dot = false;
+
+      for (auto i = 0; i < len; ++i, v <<= 5) {
+         has_dot |= !(v & mask);
+      }
+      return has_dot;
+   }
+
+   name rootname(name n) {
+      auto mask = (uint64_t) -1;
+      for (auto i = 0; i < 12; ++i) {
+         if (n.value & (0x1FULL << (4 + 5 * (11 - i))))
+            continue;
+         mask <<= 4 + 5 * (11 - i);
+         break;
+      }
+      return name(n.value & mask);
+   }
+}
+
+// xorshift64*, deterministic so that failure can be reproduced
+struct random_names {
+   uint64_t state = 0x9E3779B97F4A7C15ull;
+
+   uint64_t next() {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545F4914F6CDD1Dull;
+   }
+
+   // names with dots at random positions and random length, including 13 characters
+   name operator()() {
+      auto len = next() % 14;
+      uint64_t value = 0;
+      for (uint64_t i = 0; i < len; ++i) {
+         uint64_t c = (next() % 4 == 0) ? 0 : next() % 32;
+         if (i < 12) value |= (c & 0x1F) << (64 - 5 * (i + 1));
+         else        value |= (c & 0x0F);
+      }
+      return name(value);
+   }
+
+   // prefix of `n` with random length, possibly mutated at its last character
+   name prefix_of(name n) {
+      auto len = next() % 14;
+      uint64_t mask = len >= 13 ? ~0ull : (len ? ~0ull << (64 - 5 * len) : 0);
+      uint64_t value = n.value & mask;
+      if (len && next() % 2) value ^= len >= 13 ? 0x1 : 0x1ull << (64 - 5 * len);
+      return name(value);
+   }
+};
+
+constexpr int rounds = 300000;
+
+EOSIO_TEST_BEGIN(name_length_test)
+   random_names gen;
+   for (int i = 0; i < rounds; ++i) {
+      auto n = gen();
+      CHECK_EQUAL( gxc::name_length(n), n.length() )
+   }
+EOSIO_TEST_END
+
+EOSIO_TEST_BEGIN(has_dot_test)
+   random_names gen;
+   for (int i = 0; i < rounds; ++i) {
+      auto n = gen();
+      CHECK_EQUAL( gxc::has_dot(n), reference::has_dot(n) )
+   }
+EOSIO_TEST_END
+
+EOSIO_TEST_BEGIN(starts_with_test)
+   random_names gen;
+   for (int i = 0; i < rounds; ++i) {
+      auto n = gen();
+      auto other = gen();
+      auto prefix = gen.prefix_of(n);
+      CHECK_EQUAL( gxc::starts_with(n, prefix), reference::starts_with(n, prefix) )
+      CHECK_EQUAL( gxc::starts_with(n, other), reference::starts_with(n, other) )
+
+      auto str = prefix.to_string();
+      CHECK_EQUAL( gxc::starts_with(n, boost::string_view(str)), reference::starts_with(n, boost::string_view(str)) )
+
+      // characters out of name alphabet never match
+      str += "!";
+      CHECK_EQUAL( gxc::starts_with(n, boost::string_view(str)), reference::starts_with(n, boost::string_view(str)) )
+   }
+EOSIO_TEST_END
+
+EOSIO_TEST_BEGIN(rootname_test)
+   random_names gen;
+   for (int i = 0; i < rounds; ++i) {
+      auto n = gen();
+      CHECK_EQUAL( eosio::rootname(n), reference::rootname(n) )
+   }
+EOSIO_TEST_END
+
+int main(int argc, char* argv[]) {
+   bool verbose = false;
+   if( argc >= 2 && std::strcmp( argv[1], "-v" ) == 0 ) {
+      verbose = true;
+   }
+   silence_output(!verbose);
+
+   EOSIO_TEST(name_length_test);
+   EOSIO_TEST(has_dot_test);
+   EOSIO_TEST(starts_with_test);
+   EOSIO_TEST(rootname_test);
+   return has_failed();
+}